@@ -11,9 +11,14 @@ return function( componentName )
 	AbstractItemModelDelegate.itemEntered = function( self, view, index ) end
 	AbstractItemModelDelegate.itemPressed = function( self, view, index ) end
 	AbstractItemModelDelegate.setData = function( self, index, data, role ) end
+	AbstractItemModelDelegate.getDataBlock = function( self, indexes, roles ) return false, {} end
+	AbstractItemModelDelegate.hasChildren = function( self, parentIndex ) return self:getRowCount( parentIndex ) > 0 end
+	AbstractItemModelDelegate.canFetchMore = function( self, parentIndex ) return false end
+	AbstractItemModelDelegate.fetchMore = function( self, parentIndex ) end
 	AbstractItemModelDelegate.mimeData = function( self, indexes, mimeData ) end
 	AbstractItemModelDelegate.mimeTypes = function( self, result ) return {} end
 	AbstractItemModelDelegate.dropMimeData = function( self, mimeDta, action, row, column, parentIndex ) return false end
+	AbstractItemModelDelegate.dropIndexes = function( self, source, indexes, action, row, column, parentIndex ) return false end
 	
 	return AbstractItemModelDelegate
 end
@@ -20,6 +20,10 @@ function AbstractListModel:getColumnCount( parentIndex )
 	return 0
 end
 
+function AbstractListModel:hasChildren( parentIndex )
+	return parentIndex == -1
+end
+
 function AbstractListModel:getRow( index )
 	return 0
 end
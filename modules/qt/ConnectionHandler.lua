@@ -1,11 +1,11 @@
 local M = {}
 
 -------------------------------------------------------------------------------
--- IConnectionHandler component that dispatches all signals
+-- IBatchConnectionHandler component that dispatches all signals
 -------------------------------------------------------------------------------
-local LuaConnectionHandler = co.Component { name = "qt.LuaConnectionHandler", provides = { handler = "qt.IConnectionHandler" } }
-function LuaConnectionHandler.handler:onSignal( cookie, ... )
-	local connection = self.connections[cookie]
+local LuaConnectionHandler = co.Component { name = "qt.LuaConnectionHandler", provides = { handler = "qt.IBatchConnectionHandler" } }
+
+local function dispatch( connection, ... )
  	assert( connection.sender and connection.closure, "LuaConnectionHandler: invalid closure for the emitted signal" )
 	
 	if connection.handlerInstance then
@@ -17,12 +17,62 @@ function LuaConnectionHandler.handler:onSignal( cookie, ... )
 	end
 end
 
+function LuaConnectionHandler.handler:onSignal( cookie, ... )
+	dispatch( self.connections[cookie], ... )
+end
+
+function LuaConnectionHandler.handler:onSignals( cookies, argCounts, args )
+	local first = 1
+	for i, cookie in ipairs( cookies ) do
+		local last = first + argCounts[i] - 1
+		-- skips connections removed by closures called earlier in this batch
+		local connection = self.connections[cookie]
+		if connection then
+			dispatch( connection, unpack( args, first, last ) )
+		end
+		first = last + 1
+	end
+end
+
+function LuaConnectionHandler.handler:onSenderDestroyed( cookie )
+	-- the connection is gone: release its closure and sender wrapper
+	self.connections[cookie] = nil
+end
+
 local connections = {}
 local connectionHandler = ( LuaConnectionHandler{ connections = connections } ).handler
 
 function M.connect( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
 	local cookie = M.system:connect( wrapper._obj, signal, connectionHandler )
 	connections[cookie] = { sender = wrapper, closure = handlerClosureOrClosureName, handlerInstance = handlerInstance }
+	return cookie
+end
+
+-- mode is one of qt.ThrottleLatest (default) or qt.ThrottleFirstAndLast
+function M.connectThrottled( wrapper, signal, intervalMs, mode, handlerClosureOrClosureName, handlerInstance )
+	local cookie = M.system:connectThrottled( wrapper._obj, signal, connectionHandler, intervalMs, mode or 0 )
+	connections[cookie] = { sender = wrapper, closure = handlerClosureOrClosureName, handlerInstance = handlerInstance }
+	return cookie
+end
+
+-- closures of batched connections are called once per event loop iteration
+-- for all emissions queued in that iteration
+function M.connectBatched( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+	local cookie = M.system:connectBatched( wrapper._obj, signal, connectionHandler )
+	connections[cookie] = { sender = wrapper, closure = handlerClosureOrClosureName, handlerInstance = handlerInstance }
+	return cookie
+end
+
+-- for senders living in other threads: closures are called later, from the GUI thread
+function M.connectQueued( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+	local cookie = M.system:connectQueued( wrapper._obj, signal, connectionHandler )
+	connections[cookie] = { sender = wrapper, closure = handlerClosureOrClosureName, handlerInstance = handlerInstance }
+	return cookie
+end
+
+function M.disconnect( cookie )
+	M.system:disconnect( cookie )
+	connections[cookie] = nil
 end
 
 return M
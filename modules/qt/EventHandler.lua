@@ -46,6 +46,14 @@ local eventNames = {
 	[eventTypes.Hide]					= "onHide"
 }
 
+-- closure name to event type map
+local closureEventTypes = {}
+for k, v in pairs( eventNames ) do
+	if type( k ) == "number" then
+		closureEventTypes[v] = k
+	end
+end
+
 -- IEventHandler component that dispatches all events
 local LuaEventHandler = co.Component { name = "qt.LuaEventHandler", provides = { handler = "qt.IEventHandler" } }
 function LuaEventHandler.handler:onEvent( cookie, eventType, ... )
@@ -59,16 +67,60 @@ function LuaEventHandler.handler:onEvent( cookie, eventType, ... )
 	return true
 end
 
+function LuaEventHandler.handler:onObjectDestroyed( cookie )
+	-- the cookie may be reused by a new object
+	self.closures[cookie] = nil
+end
+
 local eventHandlerClosures = {}
 local eventHandler = ( LuaEventHandler{ closures = eventHandlerClosures } ).handler
 
+-- IDelegatedEventHandler component that dispatches the events of all routes
+local LuaDelegatedEventHandler = co.Component { name = "qt.LuaDelegatedEventHandler", provides = { handler = "qt.IDelegatedEventHandler" } }
+function LuaDelegatedEventHandler.handler:onDelegatedEvent( route, watched, eventType, ... )
+	local closures = self.routes[route]
+	local closure = closures and closures[eventNames[eventType]]
+	if not closure then
+		return true
+	end
+	-- dispatch the event to corresponding closure passing the watched object
+	local ret = closure( M.wrap( watched ), ... )
+	if ret == false then return false end
+	return true
+end
+
+local eventRoutes = {}
+local delegatedEventHandler = ( LuaDelegatedEventHandler{ routes = eventRoutes } ).handler
+
+-- Delegates the events of all objects matching the given criteria (any of
+-- which may be nil) to the closures in the 'closures' table, which are named
+-- like the event closures of a single object (e.g. { onKeyPress = function( sender, key ) end }).
+-- Returns the route id, to be passed to removeEventRoute().
+function M.addEventRoute( root, className, objectNamePattern, closures )
+	local types = {}
+	for name, closure in pairs( closures ) do
+		assert( type( closure ) == "function" and closureEventTypes[name], "invalid event closure '" .. tostring( name ) .. "'" )
+		types[#types + 1] = closureEventTypes[name]
+	end
+
+	local route = M.system:addEventRoute( root and root._obj or M.system.app, className or "", objectNamePattern or "", types, delegatedEventHandler )
+	eventRoutes[route] = closures
+	return route
+end
+
+function M.removeEventRoute( route )
+	M.system:removeEventRoute( route )
+	eventRoutes[route] = nil
+end
+
 function M.installEventHandler( wrapper, eventName, closure )
 	-- checks whether the event name exists and closure is valid
 	if type( closure ) ~= "function" or not eventNames[eventName] then
 		return false
 	end
 
-	local cookie = M.system:installEventHandler( wrapper._obj, eventHandler )
+	-- subscribes only to the event type of the closure (along with the previously installed ones)
+	local cookie = M.system:installEventHandler( wrapper._obj, eventHandler, { closureEventTypes[eventName] }, 0 )
 	eventHandlerClosures[cookie] = eventHandlerClosures[cookie] or {}
 	eventHandlerClosures[cookie][eventName] = closure
 	eventHandlerClosures[cookie].source = wrapper
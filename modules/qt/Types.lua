@@ -105,6 +105,15 @@ M.ItemIsUserCheckable		= 16
 M.ItemIsEnabled				= 32
 M.ItemIsTristate			= 64
 
+-------------------------------------------------------------------------------
+-- Export QItemSelectionModel::SelectionFlag enum (see IAbstractItemModel:selectRows())
+-------------------------------------------------------------------------------
+M.SelectionClear			= 0x1
+M.Select					= 0x2
+M.Deselect					= 0x4
+M.Toggle					= 0x8
+M.ClearAndSelect			= M.SelectionClear + M.Select
+
 -------------------------------------------------------------------------------
 -- Export Qt::DropAction enum (see AbstractItemModelDelegate:getData())
 -------------------------------------------------------------------------------
@@ -115,6 +124,9 @@ M.ActionMask 		= 0xff
 M.IgnoreAction 		= 0x0
 M.TargetMoveAction 	= 0x8002
 
+-- format of the dragged item indexes in AbstractItemModel mime data (see MimeData:getIndexes())
+M.ItemIndexesMimeType = "application/x-coral-qt-item-indexes"
+
 -------------------------------------------------------------------------------
 -- Export Qt::DragDropMode enum
 -------------------------------------------------------------------------------
@@ -243,6 +255,12 @@ M.DefaultContextMenu 	= 1
 M.ActionsContextMenu 	= 2
 M.CustomContextMenu 	= 3	
 
+-------------------------------------------------------------------------------
+-- Export throttling modes (see ISystem.connectThrottled())
+-------------------------------------------------------------------------------
+M.ThrottleLatest		= 0
+M.ThrottleFirstAndLast	= 1
+
 -------------------------------------------------------------------------------
 -- Lua constructors for supported Qt types
 -------------------------------------------------------------------------------
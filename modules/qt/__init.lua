@@ -35,14 +35,58 @@ end
 
 -- if handlerInstance is not nill then handlerClosureOrClosureName must be a name
 -- of a closure in it and will be called passing the table as self argument.
+-- Returns the connection cookie (see qt.disconnect()).
 function MT.connect( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
-	connectionHandler.connect( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+	return connectionHandler.connect( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+end
+
+-- Same as connect(), but the handler is called at most once every 'intervalMs'
+-- milliseconds (see ISystem.connectThrottled() for the available modes).
+function MT.connectThrottled( wrapper, signal, intervalMs, mode, handlerClosureOrClosureName, handlerInstance )
+	return connectionHandler.connectThrottled( wrapper, signal, intervalMs, mode, handlerClosureOrClosureName, handlerInstance )
+end
+
+-- Same as connect(), but emissions are queued natively and delivered to Lua
+-- in batches, once per event loop iteration (see ISystem.connectBatched()).
+function MT.connectBatched( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+	return connectionHandler.connectBatched( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+end
+
+-- Same as connect(), but for senders living in other threads: the handler is
+-- called later, from the GUI thread (see ISystem.connectQueued()).
+function MT.connectQueued( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
+	return connectionHandler.connectQueued( wrapper, signal, handlerClosureOrClosureName, handlerInstance )
 end
 
 function MT.invoke( wrapper, name, a1, a2, a3, a4, a5, a6, a7 )
 	return wrapper._obj:invoke( name, a1, a2, a3, a4, a5, a6, a7 )
 end
 
+-- Sets all properties in the table 'properties' (name = value) in a single call,
+-- with updates of the object (if a widget) disabled until all are set. They are set
+-- in the undefined order of pairs(), so properties that depend on each other (e.g.
+-- a range and its value) must be set through separate calls.
+function MT.setProperties( wrapper, properties )
+	local names, values = {}, {}
+	for name, value in pairs( properties ) do
+		names[#names + 1] = name
+		values[#values + 1] = value
+	end
+	wrapper._obj:setProperties( names, values )
+	return wrapper
+end
+
+-- Returns a table (name = value) with the properties listed in 'names'.
+-- Missing properties are left out.
+function MT.getProperties( wrapper, names )
+	local values = wrapper._obj:getProperties( names )
+	local properties = {}
+	for i, name in ipairs( names ) do
+		properties[name] = values[i]
+	end
+	return properties
+end
+
 function MT.__index( wrapper, name )
 	-- returns one of the ObjectWrapper utility functions
 	if MT[name] then return MT[name] end
@@ -230,7 +274,11 @@ function MT.hidePopup( comboBox )
 end
 
 function MT.setModel( view, model )
-	system:assignModelToView( view._obj, model._obj or model )
+	if M.proxyModels[model] then
+		model:installModel( view._obj )
+	else
+		system:assignModelToView( view._obj, model._obj or model )
+	end
 end
 
 function MT.setSelectionModel( view, model )
@@ -296,6 +344,16 @@ function M.loadUi( uiFile, parentWidget )
 	return ObjectWrapper( system:loadUi( uiFile, parentInstance._obj ) )
 end
 
+-- proxies created by qt.newSortFilterProxyModel() (see MT.setModel())
+M.proxyModels = setmetatable( {}, { __mode = "k" } )
+
+function M.newSortFilterProxyModel( sourceModel )
+	local proxy = co.new( "qt.SortFilterProxyModel" ).proxy
+	proxy.source = sourceModel
+	M.proxyModels[proxy] = true
+	return proxy
+end
+
 function M.getExistingDirectory( parent, caption, initialDir )
 	return system:getExistingDirectory( parent._obj, caption, initialDir )
 end
@@ -334,6 +392,92 @@ function M.setSearchPaths( prefix, paths )
 	end
 end
 
+-- Removes a connection made through connect() or any of its variants.
+-- Connections are also removed automatically when their sender is destroyed.
+function M.disconnect( cookie )
+	connectionHandler.disconnect( cookie )
+end
+
+-- Delegates the events of all objects under 'root' (or all objects, if nil)
+-- matching the optional className and objectName wildcard pattern to the
+-- event closures in 'closures' (see ISystem.addEventRoute()).
+function M.addEventRoute( root, className, objectNamePattern, closures )
+	return eventHandler.addEventRoute( root, className, objectNamePattern, closures )
+end
+
+function M.removeEventRoute( route )
+	eventHandler.removeEventRoute( route )
+end
+
+-- IValueConverter component that forwards conversions to Lua closures
+local LuaValueConverter = co.Component { name = "qt.LuaValueConverter", provides = { converter = "qt.IValueConverter" } }
+
+function LuaValueConverter.converter:toVariant( value )
+	return self.toVariantClosure( value )
+end
+
+function LuaValueConverter.converter:toAny( variant )
+	return self.toAnyClosure( variant )
+end
+
+-- Registers closures that convert values of the Qt type named 'typeName' into
+-- a qt.Variant (toVariant) and back (toAny). See ISystem.registerValueConverter().
+function M.registerValueConverter( typeName, toVariant, toAny )
+	local instance = LuaValueConverter{ toVariantClosure = toVariant, toAnyClosure = toAny }
+	system:registerValueConverter( typeName, instance.converter )
+end
+
+local function unwrapObjects( objects )
+	local unwrapped = {}
+	for i, object in ipairs( objects ) do
+		unwrapped[i] = object._obj or object
+	end
+	return unwrapped
+end
+
+-- Sets the property 'name' of all objects in the list 'objects' to 'value'
+-- (see ISystem.applyProperty()).
+function M.applyProperty( objects, name, value )
+	system:applyProperty( unwrapObjects( objects ), name, value )
+end
+
+-- Invokes the method 'methodSignature' on all objects in the list 'objects',
+-- with the same arguments (see ISystem.invokeOnAll()).
+function M.invokeOnAll( objects, methodSignature, a1, a2, a3, a4, a5, a6, a7 )
+	system:invokeOnAll( unwrapObjects( objects ), methodSignature, a1, a2, a3, a4, a5, a6, a7 )
+end
+
+-- Sends an input event straight to 'receiver'. The event is described by the
+-- fields of a qt.EventRecord in the table 'fields' (e.g. { type = 31, delta = 120 }).
+-- Returns whether the event was accepted (see ISystem.sendEvent()).
+function M.sendEvent( receiver, fields )
+	local record = co.new( "qt.EventRecord" )
+	for name, value in pairs( fields ) do
+		record[name] = value
+	end
+	return system:sendEvent( receiver._obj or receiver, record )
+end
+
+-- Enables or disables the merging of MouseMove, Wheel and Resize events
+-- (see ISystem.eventCompressionEnabled).
+function M.setEventCompressionEnabled( enabled )
+	system.eventCompressionEnabled = enabled
+end
+
+-- Enables or disables the collection of per-connection statistics, which are
+-- returned by getConnectionStats() as an array of qt.ConnectionStats.
+function M.setConnectionStatsEnabled( enabled )
+	system.connectionStatsEnabled = enabled
+end
+
+function M.getConnectionStats()
+	return system:getConnectionStats()
+end
+
+function M.resetConnectionStats()
+	system:resetConnectionStats()
+end
+
 function M.exec()
 	return system:exec()
 end
@@ -403,6 +547,7 @@ types.parent = M
 
 -- eventHandler/connectinoHandler must access system service
 eventHandler.system = system
+eventHandler.wrap = ObjectWrapper
 connectionHandler.system = system
 
 -- copy types to module table
@@ -87,39 +87,52 @@ M.colors =
 -------------------------------------------------------------------------------
 --- Utility functions
 -------------------------------------------------------------------------------
-local function loadType( typeName, parentModuleName )
-	return co.Type[parentModuleName .. '.' .. typeName]
-end
-
--- Recursively loads all types from the given directory by 
--- locating CSL files
-local function loadTypesIn( dir, parentModuleName )
-	assert( path.isDir( dir ) )
-	for filename in lfs.dir( dir ) do
-		if filename ~= "." and filename ~= ".." and path.isDir( dir .. '/' .. filename ) then
-			local nextModuleName = filename
-			if parentModuleName ~= "" then
-				nextModuleName = parentModuleName .. '.' .. nextModuleName
-			end
 
-			loadTypesIn( dir .. '/' .. filename, nextModuleName )
-		else
-			local typeName = filename:match( "(.+)%.csl$" )
-			if typeName then 
-				pcall( loadType, typeName, parentModuleName )
-			end
-		end
-	end	
+-- maximum number of children added to the tree by each fetchMore() call
+local FETCH_PAGE_SIZE = 200
+
+local function joinName( parentName, name )
+	if parentName == "" then
+		return name
+	end
+	return parentName .. '.' .. name
 end
 
--- Loads all types reachable from coral path
-local function loadAllTypes()
-	local coralPaths = co.getPaths()
+local function loadType( fullName )
+	return co.Type[fullName]
+end
 
-	for i, repositoryDir in ipairs( coralPaths ) do
-		-- avoid fatal CSL parsing errors
-		loadTypesIn( repositoryDir, "" )
+-- Lists the names of the child namespaces and types of a namespace by locating
+-- its directories and CSL files in the coral path (without loading any type)
+local function listNamespace( nsFullName )
+	local namespaces, types, seen = {}, {}, {}
+	local relativeDir = nsFullName:gsub( "%.", "/" )
+	for i, repositoryDir in ipairs( co.getPaths() ) do
+		local dir = repositoryDir
+		if relativeDir ~= "" then
+			dir = dir .. '/' .. relativeDir
+		end
+
+		if path.isDir( dir ) then
+			for filename in lfs.dir( dir ) do
+				if filename ~= "." and filename ~= ".." and not seen[filename] then
+					seen[filename] = true
+					if path.isDir( dir .. '/' .. filename ) then
+						namespaces[#namespaces + 1] = filename
+					else
+						local typeName = filename:match( "(.+)%.csl$" )
+						if typeName then
+							types[#types + 1] = typeName
+						end
+					end
+				end
+			end
+		end
 	end
+
+	table.sort( namespaces )
+	table.sort( types )
+	return namespaces, types
 end
 
 -- Gets the group name base on the number of elements in it.
@@ -186,6 +199,7 @@ function TypeTree:add( element, parentIndex )
 					parent = parentIndex,
 					docs = element.docs,
 					fullName = element.fullName,
+					expand = element.expand,
 					children = {} 
 	}
 	self[node.index] = node
@@ -208,6 +222,40 @@ function TypeTree:add( element, parentIndex )
 	return node.index
 end
 
+-- Returns whether the node has children that were not added yet
+function TypeTree:canFetchMore( index )
+	local node = self[index]
+	return node.expand ~= nil or node.pending ~= nil
+end
+
+-- Creates the next page of (at most FETCH_PAGE_SIZE) children of a node. Children are
+-- listed by the node's 'expand' function on the first call, as functions that create
+-- the child elements (or return nil to skip them); the elements are not added to the tree.
+function TypeTree:fetchPage( index )
+	local node = self[index]
+	if node.expand then
+		node.pending = node.expand()
+		node.nextPending = 1
+		node.expand = nil
+	end
+
+	local elements = {}
+	local pending = node.pending or {}
+	while #elements < FETCH_PAGE_SIZE and node.nextPending <= #pending do
+		local element = pending[node.nextPending]()
+		node.nextPending = node.nextPending + 1
+		if element then
+			elements[#elements + 1] = element
+		end
+	end
+
+	if node.pending and node.nextPending > #pending then
+		node.pending = nil
+	end
+
+	return elements
+end
+
 function getDocs( coType, memberName )
 	if memberName then
 		return "" --co.system.types:getDocumentation( coType.fullName .. ":" .. memberName )
@@ -216,114 +264,128 @@ function getDocs( coType, memberName )
 	end
 end
 
--- Creates a group of members (if any), extracted from field 'fieldName' of table currentType,
--- and adds it to type tree as child of index parentIndex.
-function TypeTree:addGenericMembers( currentType, fieldName, groupName, icon, parentIndex )
-	if currentType[fieldName] and #currentType[fieldName] > 0 then
-		for i, v in ipairs( currentType[fieldName] ) do
-			self:add( { data = v.name .. " : " .. v.type.name, 
-						icon = icon, docs = getDocs( currentType, v.name ), 
-						fullName = v.type.fullName,
-						type = groupName }, parentIndex )
-		end
-	end
+local namespaceChildren, typeChildren
+
+local function namespaceElement( name, fullName )
+	return { data = name,
+			 icon = M.icons.namespace,
+			 fullName = fullName ~= "" and fullName or "<root namespace>",
+			 type = "namespace",
+			 expand = function() return namespaceChildren( fullName ) end }
 end
 
-function TypeTree:addMemberAttributes( currentType, fieldName, groupName, icon, parentIndex )
-	if currentType[fieldName] and #currentType[fieldName] > 0 then
-		for i, v in ipairs( currentType[fieldName] ) do
-			local data = "attribute " .. v.name .. " : " .. v.type.name
-			if data.isReadOnly then
-				data = data .. " [readonly]"
-			end
+local function typeElement( currentType )
+	return { data = currentType.name, 
+			 icon = M.typeIcons[currentType.kind] or M.icons.primitiveType, 
+			 docs = getDocs( currentType ), 
+			 fullName = currentType.fullName,
+			 type = M.typeNames[currentType.kind],
+			 expand = function() return typeChildren( currentType ) end }
+end
 
-			self:add( { data = data, 
-						icon = icon, 
-						docs = getDocs( currentType, v.name ), 
-						fullName = currentType.fullName .. "." .. v.name, 
-						type = "attribute of type " .. v.type.name }, 
-						parentIndex )
-		end
+-- Element for a member (facet or receptacle) of the given groupName
+local function genericMemberElement( currentType, member, groupName, icon )
+	return { data = member.name .. " : " .. member.type.name, 
+			 icon = icon, docs = getDocs( currentType, member.name ), 
+			 fullName = member.type.fullName,
+			 type = groupName }
+end
+
+local function attributeElement( currentType, attribute )
+	local data = "attribute " .. attribute.name .. " : " .. attribute.type.name
+	if attribute.isReadOnly then
+		data = data .. " [readonly]"
 	end
+
+	return { data = data, 
+			 icon = M.icons.attribute, 
+			 docs = getDocs( currentType, attribute.name ), 
+			 fullName = currentType.fullName .. "." .. attribute.name, 
+			 type = "attribute of type " .. attribute.type.name }
 end
 
--- Creates a group of methods, extracted from field 'fieldName' of table currentType,
--- and adds it to type tree as child of index parentIndex
-function TypeTree:addMethods( currentType, fieldName, groupName, icon, parentIndex )
-	if currentType[fieldName] and #currentType[fieldName] > 0 then
-		for i, v in ipairs( currentType[fieldName] ) do
-			local methodIndex = self:add( { data = extractMethodSignature( v ), icon = icon, 
-											docs = getDocs( currentType, v.name ), 
-											fullName = currentType.fullName .. ":" .. v.name, 
-											type = "method"  }, parentIndex )
-
-			-- extracts method exceptions
-			if v.exceptions and #v.exceptions > 0 then
-				local exceptionsIndex = self:add( { data = "throws", icon = M.icons.exception }, methodIndex )
-				for j, v2 in ipairs( v.exceptions ) do
-					self:add( { data = v2.name, 
-								icon = M.icons.exception, 
-								fullName = currentType.fullName .. ":" .. v2.name, 
-								type = "exception" }, exceptionsIndex )
+local function methodElement( currentType, method )
+	local element = { data = extractMethodSignature( method ), icon = M.icons.method, 
+					  docs = getDocs( currentType, method.name ), 
+					  fullName = currentType.fullName .. ":" .. method.name, 
+					  type = "method" }
+
+	-- method exceptions are grouped under a 'throws' child
+	if method.exceptions and #method.exceptions > 0 then
+		element.expand = function()
+			local throws = { data = "throws", icon = M.icons.exception }
+			throws.expand = function()
+				local makers = {}
+				for i, v in ipairs( method.exceptions ) do
+					makers[i] = function()
+						return { data = v.name, 
+								 icon = M.icons.exception, 
+								 fullName = currentType.fullName .. ":" .. v.name, 
+								 type = "exception" }
+					end
 				end
+				return makers
 			end
+			return { function() return throws end }
 		end
 	end
+
+	return element
 end
 
-function TypeTree:addTypeMembers( currentType, parentIndex )
-	-- add facets and receptacles (components only)
-	self:addGenericMembers( currentType, "facets", "facet", M.icons.facet, parentIndex )
-	self:addGenericMembers( currentType, "receptacles", "receptacle", M.icons.receptacle, parentIndex )
+-- Appends to 'makers' one function per member in field 'fieldName' of currentType
+local function addMembers( makers, currentType, fieldName, makeElement, ... )
+	local members = currentType[fieldName]
+	if members then
+		local a, b = ...
+		for i, v in ipairs( members ) do
+			makers[#makers + 1] = function() return makeElement( currentType, v, a, b ) end
+		end
+	end
+end
 
-	-- add attributes (all types)
-	self:addMemberAttributes( currentType, "fields", "attribute", M.icons.attribute, parentIndex )
+function namespaceChildren( nsFullName )
+	local namespaces, types = listNamespace( nsFullName )
 
-	-- add methods (native class and interface only)
-	self:addMethods( currentType, "methods", "method", M.icons.method, parentIndex )
+	local makers = {}
+	for i, name in ipairs( namespaces ) do
+		makers[#makers + 1] = function() return namespaceElement( name, joinName( nsFullName, name ) ) end
+	end
+
+	for i, name in ipairs( types ) do
+		makers[#makers + 1] = function()
+			-- avoid fatal CSL parsing errors
+			local ok, currentType = pcall( loadType, joinName( nsFullName, name ) )
+			if ok and currentType then
+				return typeElement( currentType )
+			end
+		end
+	end
+
+	return makers
 end
 
-function TypeTree:addType( currentType, parentIndex )
-	local currentIndex = self:add( { data = currentType.name, 
-									 icon = M.typeIcons[currentType.kind] or M.icons.primitiveType, 
-									 docs = getDocs( currentType ), 
-									 fullName = currentType.fullName,
-									 type = M.typeNames[currentType.kind] }, parentIndex or -1 )
+function typeChildren( currentType )
+	local makers = {}
 
 	local childTypes = currentType.types
 	if childTypes then
 		for i, v in ipairs( childTypes ) do
-			self:addType( v, currentIndex )
+			makers[#makers + 1] = function() return typeElement( v ) end
 		end
 	end
 
-	self:addTypeMembers( currentType, currentIndex )
-end
+	-- add facets and receptacles (components only)
+	addMembers( makers, currentType, "facets", genericMemberElement, "facet", M.icons.facet )
+	addMembers( makers, currentType, "receptacles", genericMemberElement, "receptacle", M.icons.receptacle )
 
-function TypeTree:addNamespace( namespace, parentIndex )
-	-- adds namespace to type tree
-	local nsName = namespace.name
-	local nsFullName = namespace.fullName
-	if not nsName or nsName == "" then
-		nsName = "<root namespace>"
-	end
-	if not nsFullName or nsFullName == "" then
-		nsFullName = "<root namespace>"	
-	end
+	-- add attributes (all types)
+	addMembers( makers, currentType, "fields", attributeElement )
 
-	local currentIndex = self:add( { data = nsName, icon = M.icons.namespace, fullName = nsFullName, type = "namespace" }, parentIndex or -1 )
-	
-	local childNS = namespace.childNamespaces
-	if childNS then
-		for i, v in ipairs( childNS ) do
-			self:addNamespace( v, currentIndex )
-		end
-	end
+	-- add methods (native class and interface only)
+	addMembers( makers, currentType, "methods", methodElement )
 
-	-- adds all namespace types recursively
-	for i, v in ipairs( namespace.types ) do
-		self:addType( v, currentIndex )
-	end
+	return makers
 end
 
 function TypeTree:new()
@@ -332,10 +394,9 @@ function TypeTree:new()
 	self.nextIndex = 1
 	self.toplevelElements = {}
 
-	-- forces loading all types
-	loadAllTypes()
-
-	self:addNamespace( co.system.types.rootNS )
+	-- only the root namespace is added up front: namespaces and types are
+	-- listed (and types loaded) as the user expands the tree
+	self:add( namespaceElement( "<root namespace>", "" ), -1 )
 
 	return self
 end
@@ -343,6 +404,9 @@ end
 -- constructs and initialize a new coral type tree
 local typeTree = TypeTree:new()
 
+-- the model (see createTypeTreeModel())
+local treeModel
+
 -------------------------------------------------------------------------------
 --- Tree model to show coral type hierarchy
 -------------------------------------------------------------------------------
@@ -414,11 +478,8 @@ function TypeTreeModel:getColumnCount( parentIndex )
 		return 1
 	end
 
-	if #typeTree[parentIndex].children > 0 then
-		return 1
-	else
-		return 0
-	end
+	-- children may be loaded later (see fetchMore())
+	return 1
 end
 
 function TypeTreeModel:getRowCount( parentIndex )
@@ -428,6 +489,36 @@ function TypeTreeModel:getRowCount( parentIndex )
 	return #typeTree[parentIndex].children
 end
 
+function TypeTreeModel:hasChildren( parentIndex )
+	if not isValidIndex( parentIndex ) then
+		return #typeTree.toplevelElements > 0
+	end
+	return #typeTree[parentIndex].children > 0 or typeTree:canFetchMore( parentIndex )
+end
+
+function TypeTreeModel:canFetchMore( parentIndex )
+	return isValidIndex( parentIndex ) and typeTree:canFetchMore( parentIndex )
+end
+
+-- loads the next page of children when the view expands (or scrolls to the end of) a node
+function TypeTreeModel:fetchMore( parentIndex )
+	if not isValidIndex( parentIndex ) then
+		return
+	end
+
+	local elements = typeTree:fetchPage( parentIndex )
+	if #elements == 0 then
+		return
+	end
+
+	local firstRow = #typeTree[parentIndex].children
+	treeModel:beginInsertRows( parentIndex, firstRow, firstRow + #elements - 1 )
+	for i, element in ipairs( elements ) do
+		typeTree:add( element, parentIndex )
+	end
+	treeModel:endInsertRows()
+end
+
 local function generateHtmlInformation( fullName, elementType, docs )
 	local docsHtml = "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.0//EN\" \"http://www.w3.org/TR/REC-html40/strict.dtd\">"
 	docsHtml = docsHtml .. "<html><head><meta name=\"qrichtext\" content=\"1\" /><style type=\"text/css\">p, li { white-space: pre-wrap; } </style></head>"
@@ -474,7 +565,7 @@ function createTypeTreeModel()
 end
 
 -- creates the list model
-local treeModel = createTypeTreeModel()
+treeModel = createTypeTreeModel()
 
 -------------------------------------------------------------------------------
 --- Slots
@@ -485,9 +576,9 @@ local function onActionEditCoralPathTriggered()
 	end
 
 	-- updates type tree
+	treeModel:beginReset()
 	typeTree = TypeTree:new()
-	M.treeView:invoke( "reset()" )
-	treeModel:notifyDataChanged( 1, typeTree.nextIndex - 1 )
+	treeModel:endReset()
 	M.docsTextBrowser.plainText = "<no documentation available>"
 	M.docsTextBrowser.enabled = false
 end
@@ -4,6 +4,7 @@
  */
 
 #include "AbstractItemModel.h"
+#include "LazyMimeData.h"
 #include <ValueConverters.h>
 #include <qt/Variant.h>
 #include <qt/MimeData.h>
@@ -11,11 +12,15 @@
 #include <co/Range.h>
 
 #include <QMimeData>
+#include <QScopedPointer>
+#include <QCoreApplication>
 #include <QTextDocument>
 #include <QAbstractItemView>
+#include <QAbstractProxyModel>
 
 #include <sstream>
 #include <vector>
+#include <algorithm>
 
 #include <co/Exception.h>
 #include <co/IllegalArgumentException.h>
@@ -23,6 +28,11 @@
 namespace
 {
 	const int ID_INVALID = -1;
+
+	// bounds the number of items fetched by a single getDataBlock() call
+	const size_t MAX_PENDING_IDS = 1024;
+
+	const QEvent::Type CLEAR_DATA_EVENT = static_cast<QEvent::Type>( QEvent::registerEventType() );
 }
 
 inline co::int32 getInternalId( const QModelIndex& index )
@@ -30,9 +40,17 @@ inline co::int32 getInternalId( const QModelIndex& index )
 	return index.isValid() ? static_cast<co::int32>( index.internalId() ) : ID_INVALID;
 }
 
+// maps an index of a proxy model (e.g. a SortFilterProxyModel) down to its source model
+inline QModelIndex toSourceIndex( QModelIndex index )
+{
+	while( const QAbstractProxyModel* proxy = qobject_cast<const QAbstractProxyModel*>( index.model() ) )
+		index = proxy->mapToSource( index );
+	return index;
+}
+
 namespace qt {
 
-AbstractItemModel::AbstractItemModel()
+AbstractItemModel::AbstractItemModel() : _blockFetchSupported( true ), _clearPosted( false )
 {
 	_delegate = 0;
 	_itemObserver = 0;
@@ -46,10 +64,15 @@ void AbstractItemModel::installModel( const Object& view )
 {
 	QAbstractItemView* qtView = qobject_cast<QAbstractItemView*>( view.get() );
 	assert( qtView );
-	qtView->setModel( this );
 
-	// connect AbstractItemView slots to model signals (to allow signal forwarding to delegate of IAbstractItemModel)
-	QObject::connect( this, SIGNAL( dataChanged( QModelIndex,QModelIndex )), qtView, SLOT( dataChanged(QModelIndex,QModelIndex) ) );
+	// views of a proxy for this model keep the proxy, which forwards our changes itself
+	if( !isProxyModel( qtView->model() ) )
+	{
+		qtView->setModel( this );
+
+		// connect AbstractItemView slots to model signals (to allow signal forwarding to delegate of IAbstractItemModel)
+		QObject::connect( this, SIGNAL( dataChanged( QModelIndex,QModelIndex )), qtView, SLOT( dataChanged(QModelIndex,QModelIndex) ) );
+	}
 
 	QObject::connect( qtView, SIGNAL( activated( const QModelIndex& ) ), this, SLOT( activated( const QModelIndex& ) ) );
 	QObject::connect( qtView, SIGNAL( clicked( const QModelIndex& ) ), this, SLOT( clicked( const QModelIndex& ) ) );
@@ -64,9 +87,59 @@ void AbstractItemModel::installSelectionModel( const Object& view )
 {
 	QAbstractItemView* qtView = qobject_cast<QAbstractItemView*>( view.get() );
 	assert( qtView );
+
+	// a selection model must refer to the view's model, which may be a proxy for this model
+	QAbstractItemModel* viewModel = qtView->model();
+	if( _selectionModel->model() != viewModel )
+		_selectionModel = new QItemSelectionModel( viewModel, this );
+
 	qtView->setSelectionModel( _selectionModel );
 }
 
+bool AbstractItemModel::isProxyModel( const QAbstractItemModel* model ) const
+{
+	const QAbstractProxyModel* proxy = qobject_cast<const QAbstractProxyModel*>( model );
+	while( proxy )
+	{
+		if( proxy->sourceModel() == this )
+			return true;
+		proxy = qobject_cast<const QAbstractProxyModel*>( proxy->sourceModel() );
+	}
+	return false;
+}
+
+QModelIndex AbstractItemModel::toModelIndex( const QModelIndex& index, const QAbstractItemModel* model ) const
+{
+	if( model == this || !index.isValid() )
+		return index;
+
+	const QAbstractProxyModel* proxy = qobject_cast<const QAbstractProxyModel*>( model );
+	if( !proxy )
+		return QModelIndex();
+
+	return proxy->mapFromSource( toModelIndex( index, proxy->sourceModel() ) );
+}
+
+QItemSelection AbstractItemModel::toModelSelection( const QItemSelection& selection, const QAbstractItemModel* model ) const
+{
+	if( model == this )
+		return selection;
+
+	const QAbstractProxyModel* proxy = qobject_cast<const QAbstractProxyModel*>( model );
+	if( !proxy )
+		return QItemSelection();
+
+	return proxy->mapSelectionFromSource( toModelSelection( selection, proxy->sourceModel() ) );
+}
+
+QModelIndex AbstractItemModel::indexFromId( co::int32 id ) const
+{
+	if( id == ID_INVALID )
+		return QModelIndex();
+
+	return makeIndex( _delegate->getRow( id ), _delegate->getColumn( id ), id );
+}
+
 int	AbstractItemModel::rowCount( const QModelIndex& parent ) const
 {
 	assertDelegateValid();
@@ -79,15 +152,39 @@ int	AbstractItemModel::columnCount( const QModelIndex& parent ) const
 	return _delegate->getColumnCount( getInternalId( parent ) );
 }
 
+bool AbstractItemModel::hasChildren( const QModelIndex& parent ) const
+{
+	assertDelegateValid();
+	return _delegate->hasChildren( getInternalId( parent ) );
+}
+
+bool AbstractItemModel::canFetchMore( const QModelIndex& parent ) const
+{
+	assertDelegateValid();
+	return _delegate->canFetchMore( getInternalId( parent ) );
+}
+
+void AbstractItemModel::fetchMore( const QModelIndex& parent )
+{
+	assertDelegateValid();
+	_delegate->fetchMore( getInternalId( parent ) );
+}
+
 bool AbstractItemModel::setData( const QModelIndex& index, const QVariant& data, int role )
 {
 	assertDelegateValid();
 
 	co::Any value;
 	variantToAny( data, value );
-	bool ok = _delegate->setData( getInternalId( index ), value, role );
+	co::int32 id = getInternalId( index );
+	bool ok = _delegate->setData( id, value, role );
 	if( ok )
 	{
+		if( isCachePersistent() )
+			_dataCache.removeItem( id );
+		else
+			invalidateData();
+
 		emit dataChanged( index, index );
 	}
 
@@ -98,14 +195,144 @@ QVariant AbstractItemModel::data( const QModelIndex& index, int role ) const
 {
 	assertDelegateValid();
 
-	co::Any value;
-	_delegate->getData( getInternalId( index ), role, value );
+	co::int32 id = getInternalId( index );
 
 	QVariant result;
+	if( _dataCache.find( id, role, result ) )
+		return result;
+
+	if( _blockFetchSupported )
+	{
+		prefetch( id, role );
+		if( _dataCache.find( id, role, result ) )
+			return result;
+	}
+
+	co::Any value;
+	_delegate->getData( id, role, value );
+
 	anyToVariant( value, QMetaType::QVariant, result );
+	if( isCachePersistent() )
+		_dataCache.insert( id, role, result );
+
 	return result;
 }
 
+void AbstractItemModel::prefetch( co::int32 id, int role ) const
+{
+	std::vector<co::int32> ids;
+	std::vector<co::int32> roles;
+
+	bool newRole = ( std::find( _roles.begin(), _roles.end(), role ) == _roles.end() );
+	if( newRole )
+	{
+		// fetch the new role for the items already fetched
+		_roles.push_back( role );
+		ids = _fetchedIds;
+		roles.push_back( role );
+	}
+	else
+	{
+		// fetch all known roles for the items handed to views since the last fetch
+		ids.swap( _pendingIds );
+		_pendingIdSet.clear();
+		roles = _roles;
+
+		// skip the items that remain in a persistent cache
+		if( isCachePersistent() )
+		{
+			QVariant cached;
+			size_t kept = 0;
+			for( size_t i = 0; i < ids.size(); ++i )
+			{
+				if( !_dataCache.find( ids[i], role, cached ) )
+					ids[kept++] = ids[i];
+			}
+			ids.resize( kept );
+		}
+	}
+
+	if( std::find( ids.begin(), ids.end(), id ) == ids.end() )
+		ids.push_back( id );
+
+	std::vector<co::Any> values;
+	if( !_delegate->getDataBlock( co::Range<const co::int32>( ids ), co::Range<const co::int32>( roles ), values ) )
+	{
+		// the delegate does not support block fetching: fall back to getData() for good
+		_blockFetchSupported = false;
+		_pendingIds.clear();
+		_pendingIdSet.clear();
+		_fetchedIds.clear();
+		return;
+	}
+
+	size_t idCount = ids.size();
+	size_t roleCount = roles.size();
+	size_t count = std::min( values.size(), idCount * roleCount );
+	for( size_t i = 0; i < count; ++i )
+	{
+		QVariant v;
+		anyToVariant( values[i], QMetaType::QVariant, v );
+		_dataCache.insert( ids[i / roleCount], roles[i % roleCount], v );
+	}
+
+	if( !newRole )
+		_fetchedIds.insert( _fetchedIds.end(), ids.begin(), ids.end() );
+
+	scheduleClear();
+}
+
+void AbstractItemModel::scheduleClear() const
+{
+	if( !_clearPosted )
+	{
+		_clearPosted = true;
+		QCoreApplication::postEvent( const_cast<AbstractItemModel*>( this ), new QEvent( CLEAR_DATA_EVENT ) );
+	}
+}
+
+void AbstractItemModel::invalidateData()
+{
+	_dataCache.clear();
+	_pendingIds.clear();
+	_pendingIdSet.clear();
+	_fetchedIds.clear();
+}
+
+void AbstractItemModel::invalidateRows( co::int32 parentIndex, co::int32 firstRow )
+{
+	if( isCachePersistent() )
+		_dataCache.removeRowsFrom( parentIndex, firstRow );
+	else
+		invalidateData();
+}
+
+void AbstractItemModel::invalidateColumns( co::int32 parentIndex, co::int32 firstColumn )
+{
+	if( isCachePersistent() )
+		_dataCache.removeColumnsFrom( parentIndex, firstColumn );
+	else
+		invalidateData();
+}
+
+void AbstractItemModel::customEvent( QEvent* e )
+{
+	if( e->type() == CLEAR_DATA_EVENT )
+	{
+		// the prefetch bookkeeping only lasts one iteration, and so does the data unless the cache is persistent
+		_clearPosted = false;
+		_pendingIds.clear();
+		_pendingIdSet.clear();
+		_fetchedIds.clear();
+		if( !isCachePersistent() )
+			_dataCache.clear();
+	}
+	else
+	{
+		QAbstractItemModel::customEvent( e );
+	}
+}
+
 QVariant AbstractItemModel::headerData( int section, Qt::Orientation orientation, int role ) const
 {
 	assertDelegateValid();
@@ -131,6 +358,18 @@ QModelIndex	AbstractItemModel::index( int row, int column, const QModelIndex& pa
 	if( itemIndex == ID_INVALID )
 		return QModelIndex();
 
+	// views ask for the indexes of the items they are about to paint (many times over)
+	if( _blockFetchSupported && _pendingIds.size() < MAX_PENDING_IDS && !_pendingIdSet.contains( itemIndex ) )
+	{
+		_pendingIds.push_back( itemIndex );
+		_pendingIdSet.insert( itemIndex );
+		scheduleClear();
+	}
+
+	// positions allow structural changes to invalidate only the affected items
+	if( isCachePersistent() )
+		_dataCache.setPosition( itemIndex, parentIndex, row, column );
+
 	return makeIndex( row, column, itemIndex );
 }
 
@@ -198,23 +437,59 @@ Qt::ItemFlags AbstractItemModel::flags( const QModelIndex& index ) const
 bool AbstractItemModel::dropMimeData( const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent )
 {
 	assertDelegateValid();
-	return _delegate->dropMimeData( qt::MimeData( const_cast<QMimeData*>( data ) ), action, row, column, static_cast<co::int32>( parent.internalId() ) );
+
+	co::int32 parentIndex = getInternalId( parent );
+
+	// items dragged within this process are handed over directly, unless the delegate declines
+	const LazyMimeData* lazyData = qobject_cast<const LazyMimeData*>( data );
+	if( lazyData && lazyData->getSource() )
+	{
+		const std::vector<co::int32>& indexes = lazyData->getIndexes();
+		if( _delegate->dropIndexes( lazyData->getSource(), co::Range<const co::int32>( indexes ), action, row, column, parentIndex ) )
+			return true;
+	}
+
+	return _delegate->dropMimeData( qt::MimeData( const_cast<QMimeData*>( data ) ), action, row, column, parentIndex );
 }
 
 QMimeData* AbstractItemModel::mimeData( const QModelIndexList& indexes ) const
 {
 	assertDelegateValid();
 
-	QMimeData* mimeData = new QMimeData();
 	std::vector<co::int32> indices;
+	indices.reserve( indexes.size() );
 	foreach( const QModelIndex indice, indexes )
 	{
 		indices.push_back( getInternalId( indice ) );
 	}
 
-	qt::MimeData mimeDataWrapper( mimeData );
-	_delegate->mimeData( co::Range<const int>( indices ), mimeDataWrapper );
-	return mimeData;
+	// the delegate only serializes the items if (and when) the data is retrieved
+	std::vector<std::string> types;
+	_delegate->mimeTypes( types );
+
+	QStringList formats;
+	for( size_t i = 0; i < types.size(); ++i )
+		formats.push_back( types[i].c_str() );
+
+	return new LazyMimeData( const_cast<AbstractItemModel*>( this ), formats, indices );
+}
+
+bool AbstractItemModel::dropItems( co::Range<const co::int32> indexes, qt::IAbstractItemModel* target, co::int32 action,
+								   co::int32 row, co::int32 column, co::int32 parentIndex )
+{
+	AbstractItemModel* targetModel = dynamic_cast<AbstractItemModel*>( target );
+	if( !targetModel )
+		throw co::IllegalArgumentException( "illegal target model (must be an AbstractItemModel)" );
+
+	assertDelegateValid();
+
+	QModelIndexList items;
+	for( ; indexes; indexes.popFirst() )
+		items.push_back( indexFromId( indexes.getFirst() ) );
+
+	QScopedPointer<QMimeData> data( mimeData( items ) );
+	return targetModel->dropMimeData( data.data(), static_cast<Qt::DropAction>( action ), row, column,
+									  targetModel->indexFromId( parentIndex ) );
 }
 
  Qt::DropActions AbstractItemModel::supportedDropActions() const
@@ -232,16 +507,32 @@ void AbstractItemModel::setDelegate( qt::IAbstractItemModelDelegate* delegate )
 	_delegate = delegate;
 	if( delegate )
 		delegate->setOwner( this );
+
+	_blockFetchSupported = true;
+	invalidateData();
+}
+
+co::int32 AbstractItemModel::getDataCacheSize()
+{
+	return _dataCache.getCapacity();
+}
+
+void AbstractItemModel::setDataCacheSize( co::int32 dataCacheSize )
+{
+	_dataCache.setCapacity( std::max( dataCacheSize, 0 ) );
+	invalidateData();
 }
     
 void AbstractItemModel::beginReset()
 {
     // by now just notify begin and end (the model has already been modified)
+    invalidateData();
     beginResetModel();
 }
 
 void AbstractItemModel::endReset()
 {
+	invalidateData();
 	endResetModel();
 }
 
@@ -253,6 +544,7 @@ void AbstractItemModel::beginInsertColumns( co::int32 parentIndex, co::int32 sta
     QModelIndex parent;
     if( parentIndex != ID_INVALID  )
         parent = makeIndex( _delegate->getRow( parentIndex ), _delegate->getColumn( parentIndex ), parentIndex );
+    invalidateColumns( parentIndex, startCol );
     QAbstractItemModel::beginInsertColumns( parent, startCol, endCol );
 }
     
@@ -270,6 +562,7 @@ void AbstractItemModel::beginRemoveColumns( co::int32 parentIndex, co::int32 sta
     if( parentIndex != ID_INVALID )
         parent = makeIndex( _delegate->getRow( parentIndex ), _delegate->getColumn( parentIndex ), parentIndex );
 
+    invalidateColumns( parentIndex, startCol );
     QAbstractItemModel::beginRemoveColumns( parent, startCol, endCol );
 }
     
@@ -287,6 +580,7 @@ void AbstractItemModel::beginInsertRows( co::int32 parentIndex, co::int32 startR
     if( parentIndex != ID_INVALID  )
         parent = makeIndex( _delegate->getRow( parentIndex ), _delegate->getColumn( parentIndex ), parentIndex );
 
+    invalidateRows( parentIndex, startRow );
     QAbstractItemModel::beginInsertRows( parent, startRow, endRow );
 }
     
@@ -305,6 +599,7 @@ void AbstractItemModel::beginRemoveRows( co::int32 parentIndex, co::int32 startR
     if( parentIndex != ID_INVALID )
         parent = makeIndex( _delegate->getRow( parentIndex ), _delegate->getColumn( parentIndex ), parentIndex );
 
+    invalidateRows( parentIndex, startRow );
     QAbstractItemModel::beginRemoveRows( parent, startRow, endRow );
 }
     
@@ -319,6 +614,19 @@ void AbstractItemModel::notifyDataChanged( co::int32 fromIndex, co::int32 toInde
 	QModelIndex from = makeIndex( _delegate->getRow( fromIndex ), _delegate->getColumn( fromIndex ), fromIndex );
 	QModelIndex to = makeIndex( _delegate->getRow( toIndex ), _delegate->getColumn( toIndex ), toIndex );
 
+	if( !isCachePersistent() )
+	{
+		invalidateData();
+	}
+	else
+	{
+		// invalidate only the changed range (both corners share the same parent)
+		_dataCache.removeItem( fromIndex );
+		_dataCache.removeItem( toIndex );
+		if( fromIndex != toIndex )
+			_dataCache.removeRange( _delegate->getParentIndex( fromIndex ), from.row(), to.row(), from.column(), to.column() );
+	}
+
 	emit dataChanged( from, to );
 }
 
@@ -327,7 +635,8 @@ void AbstractItemModel::setItemSelection( co::int32 index, bool selectionState )
 	if( !_selectionModel )
 		return;
 
-	_selectionModel->select( makeIndex( _delegate->getRow( index ), _delegate->getColumn( index ), index ), selectionState?QItemSelectionModel::Select:QItemSelectionModel::Deselect );
+	QModelIndex modelIndex = makeIndex( _delegate->getRow( index ), _delegate->getColumn( index ), index );
+	_selectionModel->select( toModelIndex( modelIndex, _selectionModel->model() ), selectionState?QItemSelectionModel::Select:QItemSelectionModel::Deselect );
 }
 
 void AbstractItemModel::getSelection( std::vector<co::int32>& indexes )
@@ -339,7 +648,7 @@ void AbstractItemModel::getSelection( std::vector<co::int32>& indexes )
 	QModelIndexList mil = sel.indexes();
 	foreach( const QModelIndex indice, mil )
 	{
-		indexes.push_back( getInternalId( indice ) );
+		indexes.push_back( getInternalId( toSourceIndex( indice ) ) );
 	}
 }
 
@@ -351,34 +660,119 @@ void AbstractItemModel::clearSelection()
 	_selectionModel->clearSelection();
 }
 
+void AbstractItemModel::selectRows( co::int32 parentIndex, co::int32 firstRow, co::int32 lastRow, co::int32 command )
+{
+	assertDelegateValid();
+
+	if( firstRow < 0 || lastRow < firstRow )
+		CORAL_THROW( co::IllegalArgumentException, "illegal row range [" << firstRow << ", " << lastRow << "]" );
+
+	QModelIndex parent = indexFromId( parentIndex );
+	int lastColumn = std::max( columnCount( parent ) - 1, 0 );
+
+	QItemSelection selection( index( firstRow, 0, parent ), index( lastRow, lastColumn, parent ) );
+	QItemSelectionModel::SelectionFlags flags( command & ( QItemSelectionModel::Clear | QItemSelectionModel::Select
+		| QItemSelectionModel::Deselect | QItemSelectionModel::Toggle ) );
+
+	_selectionModel->select( toModelSelection( selection, _selectionModel->model() ), flags | QItemSelectionModel::Rows );
+}
+
+void AbstractItemModel::getSelectionRanges( std::vector<co::int32>& ranges )
+{
+	std::vector<RowRange> rows;
+	getSelectedRows( rows );
+
+	ranges.reserve( rows.size() * 3 );
+	for( size_t i = 0; i < rows.size(); ++i )
+	{
+		ranges.push_back( rows[i].parentIndex );
+		ranges.push_back( rows[i].firstRow );
+		ranges.push_back( rows[i].lastRow );
+	}
+}
+
+co::int32 AbstractItemModel::getSelectedRowCount()
+{
+	std::vector<RowRange> rows;
+	getSelectedRows( rows );
+
+	co::int32 count = 0;
+	for( size_t i = 0; i < rows.size(); ++i )
+		count += rows[i].lastRow - rows[i].firstRow + 1;
+
+	return count;
+}
+
+void AbstractItemModel::getSelectedRows( std::vector<RowRange>& ranges ) const
+{
+	const QItemSelection selection = _selectionModel->selection();
+	bool proxied = ( _selectionModel->model() != this );
+
+	RowRange range;
+	foreach( const QItemSelectionRange& r, selection )
+	{
+		if( !proxied )
+		{
+			range.parentIndex = getInternalId( r.parent() );
+			range.firstRow = r.top();
+			range.lastRow = r.bottom();
+			ranges.push_back( range );
+			continue;
+		}
+
+		// rows that are contiguous in a proxy may be scattered in this model
+		for( int row = r.top(); row <= r.bottom(); ++row )
+		{
+			QModelIndex source = toSourceIndex( r.model()->index( row, r.left(), r.parent() ) );
+			range.parentIndex = getInternalId( source.parent() );
+			range.firstRow = range.lastRow = source.row();
+			ranges.push_back( range );
+		}
+	}
+
+	// ranges may overlap (e.g. the same rows selected in several columns): merge them
+	std::sort( ranges.begin(), ranges.end() );
+
+	size_t merged = 0;
+	for( size_t i = 0; i < ranges.size(); ++i )
+	{
+		if( merged > 0 && ranges[merged - 1].parentIndex == ranges[i].parentIndex
+				&& ranges[i].firstRow <= ranges[merged - 1].lastRow + 1 )
+			ranges[merged - 1].lastRow = std::max( ranges[merged - 1].lastRow, ranges[i].lastRow );
+		else
+			ranges[merged++] = ranges[i];
+	}
+	ranges.resize( merged );
+}
+
 void AbstractItemModel::activated( const QModelIndex& index )
 {
 	if( _itemObserver.get() )
-		_itemObserver->itemActivated( qt::Object( QObject::sender() ), getInternalId( index ), _delegate.get() );
+		_itemObserver->itemActivated( qt::Object( QObject::sender() ), getInternalId( toSourceIndex( index ) ), _delegate.get() );
 }
 
 void AbstractItemModel::clicked( const QModelIndex& index )
 {
 	if( _itemObserver.get() )
-		_itemObserver->itemClicked( qt::Object( QObject::sender() ), getInternalId( index ), _delegate.get() );
+		_itemObserver->itemClicked( qt::Object( QObject::sender() ), getInternalId( toSourceIndex( index ) ), _delegate.get() );
 }
 
 void AbstractItemModel::doubleClicked( const QModelIndex& index )
 {
 	if( _itemObserver.get() )
-		_itemObserver->itemDoubleClicked( qt::Object( QObject::sender() ), getInternalId( index ), _delegate.get() );
+		_itemObserver->itemDoubleClicked( qt::Object( QObject::sender() ), getInternalId( toSourceIndex( index ) ), _delegate.get() );
 }
 
 void AbstractItemModel::entered( const QModelIndex& index )
 {
 	if( _itemObserver.get() )
-		_itemObserver->itemEntered( qt::Object( QObject::sender() ), getInternalId( index ), _delegate.get() );
+		_itemObserver->itemEntered( qt::Object( QObject::sender() ), getInternalId( toSourceIndex( index ) ), _delegate.get() );
 }
 
 void AbstractItemModel::pressed( const QModelIndex& index )
 {
 	if( _itemObserver.get() )
-		_itemObserver->itemPressed( qt::Object( QObject::sender() ), getInternalId( index ), _delegate.get() );
+		_itemObserver->itemPressed( qt::Object( QObject::sender() ), getInternalId( toSourceIndex( index ) ), _delegate.get() );
 }
 
 void AbstractItemModel::setTreeItemObserver( qt::ITreeItemObserver* itemObserver )
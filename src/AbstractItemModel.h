@@ -4,7 +4,9 @@
 #include <QAbstractItemModel>
 #include <QAbstractItemView>
 #include <QItemSelectionModel>
+#include <QSet>
 #include "AbstractItemModel_Base.h"
+#include "ItemDataCache.h"
 #include <qt/ITreeItemObserver.h>
 #include <qt/IAbstractItemModelDelegate.h>
 
@@ -29,6 +31,12 @@ public:
 
 	virtual int	columnCount( const QModelIndex& parent = QModelIndex() ) const;
 
+	virtual bool hasChildren( const QModelIndex& parent = QModelIndex() ) const;
+
+	virtual bool canFetchMore( const QModelIndex& parent ) const;
+
+	virtual void fetchMore( const QModelIndex& parent );
+
 	virtual bool setData( const QModelIndex& index, const QVariant& data, int role = Qt::EditRole );
 
 	virtual QVariant data( const QModelIndex& index, int role ) const;
@@ -52,6 +60,9 @@ public:
 	virtual qt::IAbstractItemModelDelegate* getDelegate();
 
 	void setDelegate( qt::IAbstractItemModelDelegate* delegate );
+
+	co::int32 getDataCacheSize();
+	void setDataCacheSize( co::int32 dataCacheSize );
     
     void beginReset();
    
@@ -68,13 +79,23 @@ public:
 
 	void notifyDataChanged( co::int32 fromIndex, co::int32 toIndex );
 
+	bool dropItems( co::Range<const co::int32> indexes, qt::IAbstractItemModel* target, co::int32 action,
+					co::int32 row, co::int32 column, co::int32 parentIndex );
+
 	void setItemSelection( co::int32 index, bool selectionState );
 	void getSelection( std::vector<co::int32>& indexes );
 	void clearSelection();
+	void selectRows( co::int32 parentIndex, co::int32 firstRow, co::int32 lastRow, co::int32 command );
+	void getSelectionRanges( std::vector<co::int32>& ranges );
+	co::int32 getSelectedRowCount();
 
 	void setTreeItemObserver( qt::ITreeItemObserver* itemObserver );
 	qt::ITreeItemObserver* getTreeItemObserver();
 
+protected:
+	//! Clears the data prefetched in the last event loop iteration.
+	void customEvent( QEvent* e );
+
 public slots:
 	void activated( const QModelIndex& index );
 
@@ -89,6 +110,43 @@ public slots:
 private:
 	void assertDelegateValid() const;
 
+	// whether the given model is a proxy for this model (possibly through other proxies)
+	bool isProxyModel( const QAbstractItemModel* model ) const;
+
+	// maps an index of this model to the given model, which must be this model or a proxy for it
+	QModelIndex toModelIndex( const QModelIndex& index, const QAbstractItemModel* model ) const;
+	QItemSelection toModelSelection( const QItemSelection& selection, const QAbstractItemModel* model ) const;
+
+	// gets the index of this model for an item id (or the root index for -1)
+	QModelIndex indexFromId( co::int32 id ) const;
+
+	// a range of selected rows, in the item ids of this model
+	struct RowRange
+	{
+		co::int32 parentIndex;
+		co::int32 firstRow;
+		co::int32 lastRow;
+
+		inline bool operator<( const RowRange& other ) const
+		{
+			return parentIndex < other.parentIndex || ( parentIndex == other.parentIndex && firstRow < other.firstRow );
+		}
+	};
+
+	// gets the selected rows as sorted, disjoint ranges
+	void getSelectedRows( std::vector<RowRange>& ranges ) const;
+
+	// fetches the data of a block of items through IAbstractItemModelDelegate::getDataBlock()
+	void prefetch( co::int32 id, int role ) const;
+	void scheduleClear() const;
+
+	inline bool isCachePersistent() const { return _dataCache.getCapacity() > 0; }
+
+	// invalidate the cached data of all items, or only of those moved by a structural change
+	void invalidateData();
+	void invalidateRows( co::int32 parentIndex, co::int32 firstRow );
+	void invalidateColumns( co::int32 parentIndex, co::int32 firstColumn );
+
 	// Portable wrap for createIndex() for gcc-32
 	inline QModelIndex makeIndex( int row, int col, int ident ) const
 	{
@@ -101,6 +159,17 @@ private:
 	QItemSelectionModel* _selectionModel;
 	co::RefPtr<qt::ITreeItemObserver> _itemObserver;
 	co::RefPtr<qt::IAbstractItemModelDelegate> _delegate;
+
+	// block prefetching: items handed to views through index() are fetched together, for
+	// all roles requested so far, on the first data() miss; the data lasts one iteration,
+	// unless the cache is persistent (see dataCacheSize)
+	mutable bool _blockFetchSupported; // until the delegate's getDataBlock() returns false
+	mutable bool _clearPosted;
+	mutable std::vector<co::int32> _pendingIds; // handed to views but not fetched yet
+	mutable QSet<co::int32> _pendingIdSet; // same as above, to skip repeated indexes
+	mutable std::vector<co::int32> _fetchedIds;
+	mutable std::vector<co::int32> _roles; // roles requested by views so far
+	mutable ItemDataCache _dataCache;
 };
 
 } // namespace qt
@@ -0,0 +1,87 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _ATOMICQUEUE_H_
+#define _ATOMICQUEUE_H_
+
+#include <QAtomicPointer>
+
+/*!
+	A lock-free, intrusive, multiple-producer single-consumer FIFO queue
+	(based on Dmitry Vyukov's node-based MPSC queue). Any thread may push()
+	nodes, but only a single consumer thread may pop() them.
+
+	The Node type must be default-constructible and have a public member
+	'QAtomicPointer<Node> next'. Ownership of the nodes is not managed.
+ */
+template<typename Node>
+class AtomicQueue
+{
+public:
+	AtomicQueue() : _head( &_stub ), _tail( &_stub )
+	{
+		_stub.next = 0;
+	}
+
+	//! Enqueues a node. Wait-free; may be called from any thread.
+	void push( Node* node )
+	{
+		node->next = 0;
+		Node* prev = _head.fetchAndStoreOrdered( node );
+		prev->next.fetchAndStoreRelease( node );
+	}
+
+	/*!
+		Dequeues the oldest node, or returns NULL if the queue is empty.
+		May also return NULL while a concurrent push() is halfway through;
+		producers must signal the consumer after their push() completes.
+	 */
+	Node* pop()
+	{
+		Node* tail = _tail;
+		Node* next = loadAcquire( tail->next );
+		if( tail == &_stub )
+		{
+			if( !next )
+				return 0;
+			_tail = next;
+			tail = next;
+			next = loadAcquire( next->next );
+		}
+
+		if( next )
+		{
+			_tail = next;
+			return tail;
+		}
+
+		if( tail != loadAcquire( _head ) )
+			return 0;
+
+		push( &_stub );
+
+		next = loadAcquire( tail->next );
+		if( next )
+		{
+			_tail = next;
+			return tail;
+		}
+
+		return 0;
+	}
+
+private:
+	static inline Node* loadAcquire( QAtomicPointer<Node>& p )
+	{
+		return p.fetchAndAddAcquire( 0 );
+	}
+
+private:
+	QAtomicPointer<Node> _head;
+	Node* _tail;
+	Node _stub;
+};
+
+#endif // _ATOMICQUEUE_H_
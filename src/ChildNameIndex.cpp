@@ -0,0 +1,119 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "ChildNameIndex.h"
+#include <QEvent>
+
+ChildNameIndex& ChildNameIndex::instance()
+{
+	static ChildNameIndex s_instance;
+	return s_instance;
+}
+
+ChildNameIndex::ChildNameIndex()
+{
+	// empty
+}
+
+ChildNameIndex::~ChildNameIndex()
+{
+	// empty
+}
+
+QObject* ChildNameIndex::findChild( QObject* root, const QString& name )
+{
+	if( root->children().isEmpty() )
+		return 0;
+
+	IndexMap::iterator it = _indexes.find( root );
+	if( it == _indexes.end() )
+	{
+		// drop the indexes of destroyed roots
+		IndexMap::iterator dead = _indexes.begin();
+		while( dead != _indexes.end() )
+		{
+			if( dead->second.root.isNull() )
+				_indexes.erase( dead++ );
+			else
+				++dead;
+		}
+
+		it = _indexes.insert( std::make_pair( root, Index() ) ).first;
+		it->second.dirty = true;
+	}
+
+	Index& index = it->second;
+	if( index.dirty || index.root != root )
+		build( index, root );
+
+	QObject* child = index.children.value( name );
+	if( child && child->objectName() != name )
+	{
+		// the child was renamed since the index was built
+		build( index, root );
+		child = index.children.value( name );
+	}
+	else if( !child )
+	{
+		// or another object may have been renamed to 'name'
+		child = root->findChild<QObject*>( name );
+		if( child )
+			build( index, root );
+	}
+
+	return child;
+}
+
+void ChildNameIndex::invalidate( QObject* obj )
+{
+	for( QObject* ancestor = obj->parent(); ancestor; ancestor = ancestor->parent() )
+	{
+		IndexMap::iterator it = _indexes.find( ancestor );
+		if( it != _indexes.end() )
+			it->second.dirty = true;
+	}
+}
+
+bool ChildNameIndex::eventFilter( QObject* watched, QEvent* event )
+{
+	QEvent::Type type = event->type();
+	if( type == QEvent::ChildAdded || type == QEvent::ChildRemoved )
+	{
+		IndexMap::iterator it = _indexes.find( watched );
+		if( it != _indexes.end() )
+			it->second.dirty = true;
+		invalidate( watched );
+	}
+	return false;
+}
+
+void ChildNameIndex::build( Index& index, QObject* root )
+{
+	index.root = root;
+	index.dirty = false;
+	index.children.clear();
+
+	root->installEventFilter( this );
+	addChildren( index, root );
+}
+
+void ChildNameIndex::addChildren( Index& index, QObject* parent )
+{
+	// same search order as QObject::findChild(): all children first, then their subtrees
+	const QObjectList& children = parent->children();
+	for( int i = 0; i < children.size(); ++i )
+	{
+		QObject* child = children[i];
+		const QString& name = child->objectName();
+		if( !name.isEmpty() && !index.children.contains( name ) )
+			index.children.insert( name, child );
+	}
+
+	for( int i = 0; i < children.size(); ++i )
+	{
+		children[i]->installEventFilter( this );
+		addChildren( index, children[i] );
+	}
+}
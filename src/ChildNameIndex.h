@@ -0,0 +1,68 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _CHILDNAMEINDEX_H_
+#define _CHILDNAMEINDEX_H_
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <map>
+
+/*!
+	Indexes the descendants of objects by objectName, so looking up children by name
+	(e.g. the widgets of a .ui form, from Lua) does not search the whole object tree.
+
+	Indexes are built lazily, on the first lookup under each root, and rebuilt on the
+	next lookup after a ChildAdded/ChildRemoved event anywhere in the subtree (watched
+	through an event filter on the indexed objects). Qt sends no event when an object
+	is renamed: stale hits are detected and fixed on lookup, and misses are confirmed
+	by a regular search (so only hits are faster than QObject::findChild()). Objects
+	renamed through Object.setProperty() invalidate the indexes that contain them.
+	Must only be used from the GUI thread.
+ */
+class ChildNameIndex : public QObject
+{
+public:
+	//! Returns the index shared by all Object wrappers.
+	static ChildNameIndex& instance();
+
+	virtual ~ChildNameIndex();
+
+	/*!
+		Returns a descendant of \a root called \a name, or NULL if there is none.
+		This is the object QObject::findChild() would return, unless an object was renamed
+		to a name that was already indexed: the indexed one is returned, even if the
+		renamed object comes first.
+	 */
+	QObject* findChild( QObject* root, const QString& name );
+
+	//! Invalidates the indexes that contain \a obj (e.g. after it was renamed).
+	void invalidate( QObject* obj );
+
+protected:
+	virtual bool eventFilter( QObject* watched, QEvent* event );
+
+private:
+	ChildNameIndex();
+
+	typedef QHash<QString, QObject*> NameMap;
+
+	struct Index
+	{
+		QPointer<QObject> root; // becomes null if the root is destroyed (and its address reused)
+		bool dirty;
+		NameMap children;
+	};
+
+	void build( Index& index, QObject* root );
+	void addChildren( Index& index, QObject* parent );
+
+private:
+	typedef std::map<QObject*, Index> IndexMap;
+	IndexMap _indexes;
+};
+
+#endif // _CHILDNAMEINDEX_H_
@@ -8,15 +8,31 @@
 #include <co/IllegalArgumentException.h>
 #include <qt/Exception.h>
 #include <QMetaMethod>
+#include <QTimerEvent>
+#include <QCoreApplication>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QThread>
 #include <sstream>
+#include <cstring>
 
-ConnectionHub::ConnectionHub()
+namespace {
+	const QEvent::Type FLUSH_BATCHES_EVENT = static_cast<QEvent::Type>( QEvent::registerEventType() );
+	const QEvent::Type DRAIN_QUEUE_EVENT = static_cast<QEvent::Type>( QEvent::registerEventType() );
+}
+
+ConnectionHub::ConnectionHub() : _flushPosted( false ), _nextSerial( 0 ), _drainPosted( 0 ), _statsEnabled( false )
 {
 	_baseId = QObject::metaObject()->methodCount();
+	_destroyedSignalIndex = QObject::staticMetaObject.indexOfSignal( "destroyed(QObject*)" );
+	_destroyedNoArgsSignalIndex = QObject::staticMetaObject.indexOfSignal( "destroyed()" );
 }
 
 ConnectionHub::~ConnectionHub()
 {
+	while( QueuedEmission* emission = _queuedEmissions.pop() )
+		deleteQueuedEmission( emission );
+
 	size_t count = _connections.size();
 	for( size_t i = 0; i < count; ++i )
 	{
@@ -27,6 +43,204 @@ ConnectionHub::~ConnectionHub()
 }
 
 co::int32 ConnectionHub::connect( const qt::Object& sender, const std::string& signal, qt::IConnectionHandler* handler )
+{
+	Connection* c = createConnection( sender, signal, handler );
+	c->interval = 0;
+	c->throttleMode = THROTTLE_LATEST;
+	return addConnection( c );
+}
+
+co::int32 ConnectionHub::connectThrottled( const qt::Object& sender, const std::string& signal,
+										   qt::IConnectionHandler* handler, co::int32 interval, co::int32 mode )
+{
+	if( interval <= 0 )
+		throw co::IllegalArgumentException( "illegal throttling interval (must be positive)" );
+
+	if( mode != THROTTLE_LATEST && mode != THROTTLE_FIRST_AND_LAST )
+		CORAL_THROW( co::IllegalArgumentException, "illegal throttling mode (" << mode << ")" );
+
+	Connection* c = createConnection( sender, signal, handler );
+	if( mode == THROTTLE_FIRST_AND_LAST && c->argCount > MAX_ARGS / 2 )
+	{
+		delete c;
+		CORAL_THROW( qt::Exception, "cannot deliver the first and last emissions of signals with more than "
+						<< MAX_ARGS / 2 << " arguments" );
+	}
+
+	c->interval = interval;
+	c->throttleMode = mode;
+	return addConnection( c );
+}
+
+co::int32 ConnectionHub::connectBatched( const qt::Object& sender, const std::string& signal,
+										 qt::IBatchConnectionHandler* handler )
+{
+	Connection* c = createConnection( sender, signal, handler );
+	c->interval = 0;
+	c->throttleMode = THROTTLE_LATEST;
+	c->batchHandler = handler;
+	return addConnection( c );
+}
+
+co::int32 ConnectionHub::connectQueued( const qt::Object& sender, const std::string& signal,
+										qt::IConnectionHandler* handler )
+{
+	Connection* c = createConnection( sender, signal, handler );
+	c->interval = 0;
+	c->throttleMode = THROTTLE_LATEST;
+	c->crossThread = true;
+	return addConnection( c );
+}
+
+void ConnectionHub::setStatsEnabled( bool enabled )
+{
+	if( enabled && !_clock.isValid() )
+		_clock.start();
+	_statsEnabled = enabled;
+}
+
+void ConnectionHub::getStats( std::vector<qt::ConnectionStats>& stats )
+{
+	stats.clear();
+	co::int32 count = static_cast<co::int32>( _connections.size() );
+	for( co::int32 cookie = 0; cookie < count; ++cookie )
+	{
+		if( !_connections[cookie] )
+			continue;
+
+		const Stats& s = _stats[cookie];
+		stats.push_back( qt::ConnectionStats() );
+		qt::ConnectionStats& cs = stats.back();
+		cs.cookie = cookie;
+		cs.emissionCount = s.emissionCount;
+		cs.dispatchCount = s.dispatchCount;
+		cs.conversionTime = s.conversionTime;
+		cs.handlerTime = s.handlerTime;
+		cs.maxHandlerTime = s.maxHandlerTime;
+		cs.latencyHistogram.assign( s.histogram, s.histogram + HISTOGRAM_BUCKETS );
+	}
+}
+
+void ConnectionHub::resetStats()
+{
+	if( !_stats.empty() )
+		memset( &_stats[0], 0, sizeof(Stats) * _stats.size() );
+}
+
+void ConnectionHub::disconnect( co::int32 cookie )
+{
+	if( cookie < 0 || cookie >= static_cast<co::int32>( _connections.size() ) || !_connections[cookie] )
+		throw co::IllegalArgumentException( "illegal out-of-range cookie" );
+
+	removeConnection( cookie, true );
+	_freeCookies.push_back( cookie );
+}
+
+int ConnectionHub::qt_metacall( QMetaObject::Call call, int id, void **arguments )
+{
+	id = QObject::qt_metacall( call, id, arguments );
+	if( id == -1 || call != QMetaObject::InvokeMetaMethod )
+		return id;
+
+	// emissions from other threads are queued for the hub's thread
+	bool foreignThread = ( QThread::currentThread() != thread() );
+
+	if( id == SLOT_SENDER_DESTROYED )
+	{
+		QObject* sender = *reinterpret_cast<QObject**>( arguments[1] );
+		if( foreignThread )
+			postSenderDestroyed( sender );
+		else
+			senderDestroyed( sender, arguments, 0 );
+		return -1;
+	}
+
+	co::int32 cookie = id - FIRST_CONNECTION_SLOT;
+	if( foreignThread )
+	{
+		postEmission( cookie, arguments );
+		return -1;
+	}
+
+	assert( cookie < static_cast<co::int32>( _connections.size() ) );
+
+	// the connection may have been removed earlier in the same emission (e.g. by
+	// our own destroyed() tracker, which delivers destroyed() before removing it)
+	Connection* c = _connections[cookie];
+	if( !c )
+		return -1;
+
+	if( isDestroyedSignal( c->signalIndex ) )
+	{
+		deliverDestroyed( cookie, c, arguments );
+		return -1;
+	}
+
+	// queued connections are never called synchronously, even from the hub's thread
+	if( c->crossThread )
+	{
+		postEmission( cookie, arguments );
+		return -1;
+	}
+
+	if( _statsEnabled )
+		++_stats[cookie].emissionCount;
+
+	if( c->batchHandler )
+	{
+		enqueue( cookie, c, arguments );
+		return -1;
+	}
+
+	if( c->interval > 0 )
+	{
+		throttle( cookie, c, arguments );
+		return -1;
+	}
+
+	// convert the raw arguments straight into the array of anys
+	co::Any args[MAX_ARGS];
+	convertArguments( cookie, c, arguments, args );
+
+	// dispatch the signal
+	dispatch( cookie, c, args );
+
+	return -1;
+}
+
+void ConnectionHub::timerEvent( QTimerEvent* e )
+{
+	TimerMap::iterator it = _throttleTimers.find( e->timerId() );
+	if( it == _throttleTimers.end() )
+	{
+		QObject::timerEvent( e );
+		return;
+	}
+
+	co::int32 cookie = it->second;
+	_throttleTimers.erase( it );
+
+	Connection* c = _connections[cookie];
+	assert( c && c->hasPending );
+
+	// the interval is over: deliver the collapsed emissions
+	c->timer.stop();
+	c->hasPending = false;
+	dispatch( cookie, c, c->pending );
+}
+
+void ConnectionHub::customEvent( QEvent* e )
+{
+	if( e->type() == FLUSH_BATCHES_EVENT )
+		flushBatches();
+	else if( e->type() == DRAIN_QUEUE_EVENT )
+		drainQueuedEmissions();
+	else
+		QObject::customEvent( e );
+}
+
+ConnectionHub::Connection* ConnectionHub::createConnection( const qt::Object& sender, const std::string& signal,
+															qt::IConnectionHandler* handler )
 {
 	QObject* qobj = sender.get();
 	if( !qobj )
@@ -41,15 +255,6 @@ co::int32 ConnectionHub::connect( const qt::Object& sender, const std::string& s
 	if( signalIndex == -1 )
 		CORAL_THROW( qt::Exception, "no such signal (" << theSignal.constData() << ") in the sender" );
 
-	co::int32 cookie = static_cast<co::int32>( _connections.size() );
-	if( !QMetaObject::connect( qobj, signalIndex, this, _baseId + cookie ) )
-		throw qt::Exception( "QMetaObject::connect() failed unexpectedly" );
-
-	Connection* c = new Connection;
-	c->sender = qobj;
-	c->signalIndex = signalIndex;
-	c->handler = handler;
-
 	// resolve the signal's argument types
 	const QMetaMethod& mm = mo->method( signalIndex );
 	QList<QByteArray> params = mm.parameterTypes();
@@ -57,61 +262,502 @@ co::int32 ConnectionHub::connect( const qt::Object& sender, const std::string& s
 	if( count > MAX_ARGS )
 		CORAL_THROW( qt::Exception, "cannot connect to signals with more than " << MAX_ARGS << " arguments" );
 
-	int i;
-	for( i = 0; i < count; ++i )
+	int argTypes[MAX_ARGS];
+	for( int i = 0; i < count; ++i )
 	{
-		int tp = QMetaType::type( params[i].constData() );
-		if( !tp )
+		argTypes[i] = QMetaType::type( params[i].constData() );
+		if( !argTypes[i] )
 			CORAL_THROW( qt::Exception, "signal parameter type '" << params[i].constData()
 							<< "' not registered with qRegisterMetaType()" );
-		c->argTypes[i] = tp;
 	}
 
-	// mark the end of the argTypes list
-	if( i < MAX_ARGS )
-		c->argTypes[i] = -1;
+	Connection* c = new Connection;
+	c->sender = qobj;
+	c->signalIndex = signalIndex;
+	c->handler = handler;
+	c->argCount = count;
+	c->batchHandler = NULL;
+	c->queued = 0;
+	c->crossThread = false;
+	c->senderDestroyed = false;
+	c->destroyedDelivered = false;
+	c->hasPending = false;
 
-	_connections.push_back( c );
+	for( int i = 0; i < count; ++i )
+	{
+		c->argTypes[i] = argTypes[i];
+		c->converters[i] = getArgumentToAnyConverter( argTypes[i] );
+	}
+
+	return c;
+}
+
+co::int32 ConnectionHub::addConnection( Connection* c )
+{
+	// reuse the cookie (and dynamic slot) of a removed connection, if any
+	co::int32 cookie;
+	if( _freeCookies.empty() )
+	{
+		cookie = static_cast<co::int32>( _connections.size() );
+		QWriteLocker locker( &_connectionsLock ); // the vector may be reallocated
+		_connections.push_back( NULL );
+	}
+	else
+	{
+		cookie = _freeCookies.back();
+		_freeCookies.pop_back();
+	}
+
+	// queued connections are called directly in the emitting thread, which then queues the emission
+	int type = c->crossThread ? Qt::DirectConnection : Qt::AutoConnection;
+	if( !QMetaObject::connect( c->sender, c->signalIndex, this, connectionSlot( cookie ), type ) )
+	{
+		_freeCookies.push_back( cookie );
+		delete c;
+		throw qt::Exception( "QMetaObject::connect() failed unexpectedly" );
+	}
+
+	QWriteLocker locker( &_connectionsLock );
+
+	// start tracking the sender's destruction (in its own thread) along with its first connection
+	if( !hasLiveConnections( c->sender ) )
+		QMetaObject::connect( c->sender, _destroyedSignalIndex, this, _baseId + SLOT_SENDER_DESTROYED, Qt::DirectConnection );
+
+	_senders.insert( SenderMap::value_type( c->sender, cookie ) );
+	c->serial = _nextSerial++;
+	_connections[cookie] = c;
+
+	// statistics are not inherited from the cookie's previous connection
+	if( _stats.size() < _connections.size() )
+		_stats.resize( _connections.size() );
+	memset( &_stats[cookie], 0, sizeof(Stats) );
 
 	return cookie;
 }
 
-void ConnectionHub::disconnect( co::int32 cookie )
+void ConnectionHub::removeConnection( co::int32 cookie, bool senderAlive )
 {
-	if( cookie < 0 || cookie > static_cast<co::int32>( _connections.size() ) )
-		throw co::IllegalArgumentException( "illegal out-of-range cookie" );
+	QWriteLocker locker( &_connectionsLock );
 
 	Connection* c = _connections[cookie];
-	QMetaObject::disconnect( c->sender, c->signalIndex, this, _baseId + cookie );
+	assert( c );
+
+	if( senderAlive && !c->senderDestroyed )
+	{
+		QMetaObject::disconnect( c->sender, c->signalIndex, this, connectionSlot( cookie ) );
+
+		std::pair<SenderMap::iterator, SenderMap::iterator> range = _senders.equal_range( c->sender );
+		for( SenderMap::iterator it = range.first; it != range.second; ++it )
+		{
+			if( it->second == cookie )
+			{
+				_senders.erase( it );
+				break;
+			}
+		}
+
+		// stop tracking the sender along with its last connection
+		if( !hasLiveConnections( c->sender ) )
+			QMetaObject::disconnect( c->sender, _destroyedSignalIndex, this, _baseId + SLOT_SENDER_DESTROYED );
+	}
+	else if( senderAlive )
+	{
+		// the sender died in another thread; we will be notified through the queue
+		std::pair<SenderMap::iterator, SenderMap::iterator> range = _senders.equal_range( c->sender );
+		for( SenderMap::iterator it = range.first; it != range.second; ++it )
+		{
+			if( it->second == cookie )
+			{
+				_senders.erase( it );
+				break;
+			}
+		}
+	}
+
+	if( c->timer.isActive() )
+	{
+		_throttleTimers.erase( c->timer.timerId() );
+		c->timer.stop();
+	}
+
+	// queued emissions must not reach a future connection that recycles the cookie
+	if( c->queued > 0 )
+		unqueue( cookie );
+
 	delete c;
 
 	_connections[cookie] = NULL;
 }
 
-int ConnectionHub::qt_metacall( QMetaObject::Call call, int id, void **arguments )
+void ConnectionHub::senderDestroyed( QObject* sender, void** arguments, co::uint32 noticeSerial )
 {
-	id = QObject::qt_metacall( call, id, arguments );
-	if( id == -1 || call != QMetaObject::InvokeMetaMethod )
-		return id;
+	std::vector<co::int32> cookies;
+	std::vector<co::uint32> serials;
+	{
+		QWriteLocker locker( &_connectionsLock );
+		std::pair<SenderMap::iterator, SenderMap::iterator> range = _senders.equal_range( sender );
+		for( SenderMap::iterator it = range.first; it != range.second; )
+		{
+			// a new object at the same address keeps the connections made after the notice
+			Connection* c = _connections[it->second];
+			bool applies = ( arguments ? !c->senderDestroyed :
+				c->senderDestroyed && static_cast<co::int32>( c->serial - noticeSerial ) < 0 );
+			if( !applies )
+			{
+				++it;
+				continue;
+			}
 
-	assert( id < static_cast<int>( _connections.size() ) );
+			cookies.push_back( it->second );
+			serials.push_back( c->serial );
+			_senders.erase( it++ );
+		}
+	}
 
-	Connection* c = _connections[id];
-	assert( c );
+	// connections to destroyed() that Qt has not signaled yet are called before their removal;
+	// their handlers may remove other connections, whose cookies may even be recycled
+	size_t count = cookies.size();
+	if( arguments )
+	{
+		for( size_t i = 0; i < count; ++i )
+		{
+			Connection* c = _connections[cookies[i]];
+			if( c && c->serial == serials[i] && isDestroyedSignal( c->signalIndex ) )
+				deliverDestroyed( cookies[i], c, arguments );
+		}
+	}
+
+	// Qt itself tears down the dying sender's connections, but only after destroyed() is
+	// emitted: until then, a recycled cookie could still receive the sender's emission
+	for( size_t i = 0; i < count; ++i )
+	{
+		co::int32 cookie = cookies[i];
+		Connection* c = _connections[cookie];
+		if( !c || c->serial != serials[i] )
+			continue; // removed by a handler of destroyed()
+
+		if( arguments )
+			QMetaObject::disconnect( sender, c->signalIndex, this, connectionSlot( cookie ) );
+
+		co::RefPtr<qt::IConnectionHandler> handler( c->handler );
+		removeConnection( cookie, false );
+
+		// the handler must release the cookie before it can be recycled
+		handler->onSenderDestroyed( cookie );
+		_freeCookies.push_back( cookie );
+	}
+}
+
+bool ConnectionHub::hasLiveConnections( QObject* sender ) const
+{
+	std::pair<SenderMap::const_iterator, SenderMap::const_iterator> range = _senders.equal_range( sender );
+	for( SenderMap::const_iterator it = range.first; it != range.second; ++it )
+	{
+		if( !_connections[it->second]->senderDestroyed )
+			return true;
+	}
+	return false;
+}
+
+void ConnectionHub::deliverDestroyed( co::int32 cookie, Connection* c, void** arguments )
+{
+	// the sender's destroyed() reaches each connection once, either from Qt or from our tracker
+	if( c->destroyedDelivered )
+		return;
+
+	c->destroyedDelivered = true;
+
+	if( _statsEnabled )
+		++_stats[cookie].emissionCount;
 
-	// create the array of arguments
 	co::Any args[MAX_ARGS];
-	for( int i = 0; i < MAX_ARGS; ++i )
+	convertArguments( cookie, c, arguments, args );
+	dispatch( cookie, c, args );
+}
+
+void ConnectionHub::throttle( co::int32 cookie, Connection* c, void** arguments )
+{
+	if( !c->hasPending )
 	{
-		if( c->argTypes[i] == -1 )
-			break;
-		QMetaType::Type tp = static_cast<QMetaType::Type>( c->argTypes[i] );
-		QVariant variant( tp, arguments[i + 1] );
-		variantToAny( variant, args[i] );
+		// first emission in this interval
+		convertArguments( cookie, c, arguments, c->pending );
+		if( c->throttleMode == THROTTLE_FIRST_AND_LAST )
+			convertArguments( cookie, c, arguments, c->pending + c->argCount );
+
+		c->hasPending = true;
+		c->timer.start( c->interval, this );
+		_throttleTimers[c->timer.timerId()] = cookie;
+		return;
 	}
 
-	// dispatch the signal
-	c->handler->onSignal( id, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7] );
+	// collapse into the pending emission
+	if( c->throttleMode == THROTTLE_LATEST )
+		convertArguments( cookie, c, arguments, c->pending );
+	else
+		convertArguments( cookie, c, arguments, c->pending + c->argCount );
+}
 
-	return -1;
+void ConnectionHub::dispatch( co::int32 cookie, Connection* c, const co::Any* args )
+{
+	// keeps the handler alive in case it removes the connection
+	co::RefPtr<qt::IConnectionHandler> handler( c->handler );
+
+	if( !_statsEnabled )
+	{
+		handler->onSignal( cookie, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7] );
+		return;
+	}
+
+	qint64 start = _clock.nsecsElapsed();
+	handler->onSignal( cookie, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7] );
+	recordDispatch( cookie, _clock.nsecsElapsed() - start );
+}
+
+void ConnectionHub::recordDispatch( co::int32 cookie, qint64 time )
+{
+	Stats& s = _stats[cookie];
+	++s.dispatchCount;
+	s.handlerTime += time;
+	if( time > s.maxHandlerTime )
+		s.maxHandlerTime = time;
+
+	int bucket = 0;
+	for( qint64 us = time / 1000; us > 1 && bucket < HISTOGRAM_BUCKETS - 1; us >>= 1 )
+		++bucket;
+	++s.histogram[bucket];
+}
+
+void ConnectionHub::enqueue( co::int32 cookie, Connection* c, void** arguments )
+{
+	if( c->argCount > 0 )
+	{
+		size_t first = _batchArgs.size();
+		_batchArgs.resize( first + c->argCount );
+		convertArguments( cookie, c, arguments, &_batchArgs[first] );
+	}
+
+	_batchCookies.push_back( cookie );
+	_batchArgCounts.push_back( c->argCount );
+	++c->queued;
+
+	// schedule a flush for the next event loop iteration
+	if( !_flushPosted )
+	{
+		_flushPosted = true;
+		QCoreApplication::postEvent( this, new QEvent( FLUSH_BATCHES_EVENT ) );
+	}
+}
+
+void ConnectionHub::unqueue( co::int32 cookie )
+{
+	size_t count = _batchCookies.size();
+	size_t kept = 0, keptArg = 0, arg = 0;
+	for( size_t i = 0; i < count; ++i )
+	{
+		co::int32 argCount = _batchArgCounts[i];
+		if( _batchCookies[i] != cookie )
+		{
+			_batchCookies[kept] = _batchCookies[i];
+			_batchArgCounts[kept] = argCount;
+			for( co::int32 j = 0; j < argCount; ++j )
+				_batchArgs[keptArg++] = _batchArgs[arg + j];
+			++kept;
+		}
+		arg += argCount;
+	}
+
+	_batchCookies.resize( kept );
+	_batchArgCounts.resize( kept );
+	_batchArgs.resize( keptArg );
+}
+
+void ConnectionHub::flushBatches()
+{
+	_flushPosted = false;
+
+	// emissions made while the batch is delivered go to the next batch
+	std::vector<co::int32> cookies;
+	std::vector<co::int32> argCounts;
+	std::vector<co::Any> args;
+	cookies.swap( _batchCookies );
+	argCounts.swap( _batchArgCounts );
+	args.swap( _batchArgs );
+
+	// resolve the handlers up front, since they may remove connections
+	size_t count = cookies.size();
+	std::vector<co::RefPtr<qt::IBatchConnectionHandler> > handlers( count );
+	std::vector<co::uint32> serials( count );
+	for( size_t i = 0; i < count; ++i )
+	{
+		Connection* c = _connections[cookies[i]];
+		assert( c && c->queued > 0 );
+		--c->queued;
+		handlers[i] = c->batchHandler;
+		serials[i] = c->serial;
+	}
+
+	// deliver each run of consecutive emissions with the same handler in a single call
+	size_t begin = 0, argBegin = 0;
+	while( begin < count )
+	{
+		size_t end = begin, argEnd = argBegin;
+		while( end < count && handlers[end].get() == handlers[begin].get() )
+			argEnd += argCounts[end++];
+
+		// earlier calls may have removed connections (and their cookies may have been recycled)
+		size_t kept = begin, keptArg = argBegin;
+		for( size_t i = begin, arg = argBegin; i < end; arg += argCounts[i++] )
+		{
+			Connection* c = _connections[cookies[i]];
+			if( !c || c->serial != serials[i] )
+				continue;
+
+			if( kept != i )
+			{
+				cookies[kept] = cookies[i];
+				serials[kept] = serials[i];
+				argCounts[kept] = argCounts[i];
+				for( co::int32 j = 0; j < argCounts[i]; ++j )
+					args[keptArg + j] = args[arg + j];
+			}
+			keptArg += argCounts[kept++];
+		}
+
+		if( kept == begin )
+		{
+			begin = end;
+			argBegin = argEnd;
+			continue;
+		}
+
+		co::Range<const co::Any> argsRange;
+		if( keptArg > argBegin )
+			argsRange = co::Range<const co::Any>( &args[argBegin], keptArg - argBegin );
+
+		bool statsEnabled = _statsEnabled;
+		qint64 start = ( statsEnabled ? _clock.nsecsElapsed() : 0 );
+
+		handlers[begin]->onSignals( co::Range<const co::int32>( &cookies[begin], kept - begin ),
+									co::Range<const co::int32>( &argCounts[begin], kept - begin ),
+									argsRange );
+
+		// the call's time is split evenly among the delivered emissions
+		if( statsEnabled )
+		{
+			qint64 time = ( _clock.nsecsElapsed() - start ) / static_cast<qint64>( kept - begin );
+			for( size_t i = begin; i < kept; ++i )
+			{
+				Connection* c = _connections[cookies[i]];
+				if( c && c->serial == serials[i] )
+					recordDispatch( cookies[i], time );
+			}
+		}
+
+		begin = end;
+		argBegin = argEnd;
+	}
+}
+
+void ConnectionHub::postEmission( co::int32 cookie, void** arguments )
+{
+	QueuedEmission* emission = new QueuedEmission;
+	emission->cookie = cookie;
+	emission->destroyedSender = NULL;
+	{
+		QReadLocker locker( &_connectionsLock );
+		Connection* c = ( cookie < static_cast<co::int32>( _connections.size() ) ? _connections[cookie] : NULL );
+		if( !c || !c->crossThread )
+		{
+			// raced with a disconnect() in the hub's thread
+			delete emission;
+			return;
+		}
+
+		emission->serial = c->serial;
+		emission->argCount = c->argCount;
+		for( int i = 0; i < c->argCount; ++i )
+		{
+			emission->argTypes[i] = c->argTypes[i];
+			emission->args[i] = QMetaType::construct( c->argTypes[i], arguments[i + 1] );
+		}
+	}
+
+	post( emission );
+}
+
+void ConnectionHub::postSenderDestroyed( QObject* sender )
+{
+	co::uint32 serial;
+	{
+		// keeps the hub's thread from touching the dying sender until it is notified
+		QWriteLocker locker( &_connectionsLock );
+		std::pair<SenderMap::iterator, SenderMap::iterator> range = _senders.equal_range( sender );
+		for( SenderMap::iterator it = range.first; it != range.second; ++it )
+			_connections[it->second]->senderDestroyed = true;
+
+		// the notice applies to the connections made so far, and not to those of a
+		// new object that reuses the sender's address before the notice is drained
+		serial = _nextSerial;
+	}
+
+	QueuedEmission* emission = new QueuedEmission;
+	emission->cookie = -1;
+	emission->serial = serial;
+	emission->destroyedSender = sender;
+	emission->argCount = 0;
+	post( emission );
+}
+
+void ConnectionHub::post( QueuedEmission* emission )
+{
+	_queuedEmissions.push( emission );
+
+	// wake up the hub's thread, unless a drain is already pending
+	if( _drainPosted.testAndSetOrdered( 0, 1 ) )
+		QCoreApplication::postEvent( this, new QEvent( DRAIN_QUEUE_EVENT ) );
+}
+
+void ConnectionHub::drainQueuedEmissions()
+{
+	// reset before draining, so emissions posted from now on trigger a new drain
+	_drainPosted.fetchAndStoreOrdered( 0 );
+
+	while( QueuedEmission* emission = _queuedEmissions.pop() )
+	{
+		if( emission->destroyedSender )
+		{
+			senderDestroyed( emission->destroyedSender, NULL, emission->serial );
+		}
+		else
+		{
+			// skips emissions of removed connections (even if their cookie was recycled)
+			Connection* c = _connections[emission->cookie];
+			if( c && c->serial == emission->serial )
+			{
+				qint64 start = ( _statsEnabled ? _clock.nsecsElapsed() : 0 );
+
+				co::Any args[MAX_ARGS];
+				for( int i = 0; i < emission->argCount; ++i )
+					c->converters[i]( emission->argTypes[i], emission->args[i], args[i] );
+
+				if( _statsEnabled )
+				{
+					Stats& s = _stats[emission->cookie];
+					++s.emissionCount;
+					s.conversionTime += _clock.nsecsElapsed() - start;
+				}
+
+				dispatch( emission->cookie, c, args );
+			}
+		}
+
+		deleteQueuedEmission( emission );
+	}
+}
+
+void ConnectionHub::deleteQueuedEmission( QueuedEmission* emission )
+{
+	for( int i = 0; i < emission->argCount; ++i )
+		QMetaType::destroy( emission->argTypes[i], emission->args[i] );
+	delete emission;
 }
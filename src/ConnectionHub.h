@@ -6,17 +6,37 @@
 #ifndef _CONNECTIONHUB_H_
 #define _CONNECTIONHUB_H_
 
+#include "AtomicQueue.h"
+#include "ValueConverters.h"
 #include <qt/Object.h>
 #include <qt/IConnectionHandler.h>
+#include <qt/IBatchConnectionHandler.h>
+#include <qt/ConnectionStats.h>
+#include <QElapsedTimer>
+#include <QReadWriteLock>
+#include <QBasicTimer>
 #include <QObject>
 #include <vector>
+#include <map>
 
 /*!
 	A dynamic QObject for dispatching signals to IConnectionHandlers.
 	Supports an arbitrary number of connections through the use of dynamic slots.
+	Cookies (and their dynamic slots) are recycled once a connection is removed,
+	and connections are automatically removed when their sender is destroyed.
+	All methods must be called from the thread that owns the hub (the GUI thread);
+	only queued connections may have senders living in other threads.
  */
 class ConnectionHub : public QObject
 {
+public:
+	//! How throttled connections collapse the emissions within an interval.
+	enum ThrottleMode
+	{
+		THROTTLE_LATEST = 0,		//!< delivers the arguments of the last emission.
+		THROTTLE_FIRST_AND_LAST = 1	//!< delivers the first emission's arguments followed by the last's.
+	};
+
 public:
 	ConnectionHub();
 
@@ -29,25 +49,192 @@ public:
 	 */
 	co::int32 connect( const qt::Object& sender, const std::string& signal, qt::IConnectionHandler* handler );
 
+	/*!
+		Same as connect(), but the \a handler is called at most once every \a interval
+		milliseconds. Emissions within an interval are collapsed according to \a mode.
+	 */
+	co::int32 connectThrottled( const qt::Object& sender, const std::string& signal,
+								qt::IConnectionHandler* handler, co::int32 interval, co::int32 mode );
+
+	/*!
+		Same as connect(), but emissions are queued and delivered to the \a handler
+		in batches, through a single IBatchConnectionHandler::onSignals() call per
+		event loop iteration.
+	 */
+	co::int32 connectBatched( const qt::Object& sender, const std::string& signal,
+							  qt::IBatchConnectionHandler* handler );
+
+	/*!
+		Same as connect(), but for senders living in other threads: the emitting thread
+		copies the arguments into a lock-free queue, and the \a handler is called later
+		from the hub's thread (emissions from the hub's own thread are queued too).
+	 */
+	co::int32 connectQueued( const qt::Object& sender, const std::string& signal,
+							 qt::IConnectionHandler* handler );
+
 	//! Removes the connection identified by the given \a cookie.
 	void disconnect( co::int32 cookie );
 
+	//! Enables or disables the collection of per-connection statistics (disabled by default).
+	void setStatsEnabled( bool enabled );
+
+	inline bool getStatsEnabled() const { return _statsEnabled; }
+
+	//! Gets the statistics collected for all existing connections.
+	void getStats( std::vector<qt::ConnectionStats>& stats );
+
+	//! Clears the statistics collected so far.
+	void resetStats();
+
 	//! Handles signals emissions.
 	int qt_metacall( QMetaObject::Call call, int id, void **arguments );
 
+protected:
+	//! Flushes throttled connections.
+	void timerEvent( QTimerEvent* e );
+
+	//! Flushes the queue of batched emissions and drains the queue of cross-thread emissions.
+	void customEvent( QEvent* e );
+
 private:
-	co::int32 _baseId;
+	// dynamic slot layout: the first slot tracks sender destruction, followed by one slot per cookie
+	static const int SLOT_SENDER_DESTROYED = 0;
+	static const int FIRST_CONNECTION_SLOT = 1;
 
 	static const int MAX_ARGS = 8;
+
+	// handler latency histogram: bucket i counts calls that took [2^i, 2^(i+1)) microseconds
+	static const int HISTOGRAM_BUCKETS = 20;
+	struct Stats
+	{
+		co::int64 emissionCount;
+		co::int64 dispatchCount;
+		co::int64 conversionTime; // nanoseconds
+		co::int64 handlerTime; // nanoseconds
+		co::int64 maxHandlerTime; // nanoseconds
+		co::int32 histogram[HISTOGRAM_BUCKETS];
+	};
+
 	struct Connection
 	{
 		QObject* sender;
 		int signalIndex;
+		int argCount;
 		int argTypes[MAX_ARGS];
+		ArgumentToAnyConverter converters[MAX_ARGS]; // resolved at connection time
 		co::RefPtr<qt::IConnectionHandler> handler;
+		qt::IBatchConnectionHandler* batchHandler; // same as handler for batched connections, NULL otherwise
+		int queued; // number of emissions in the batch queue
+		bool crossThread; // whether emissions come from other threads (see connectQueued())
+		bool senderDestroyed; // set by other threads when the sender dies before we are notified
+		bool destroyedDelivered; // whether the sender's destroyed() was already delivered
+		co::uint32 serial; // distinguishes connections that recycle the same cookie
+
+		// throttling state (only used if interval > 0)
+		int interval;
+		int throttleMode;
+		bool hasPending;
+		QBasicTimer timer;
+		co::Any pending[MAX_ARGS];
+	};
+
+	Connection* createConnection( const qt::Object& sender, const std::string& signal, qt::IConnectionHandler* handler );
+	co::int32 addConnection( Connection* c );
+
+	// destroys the connection; callers are responsible for recycling its cookie
+	void removeConnection( co::int32 cookie, bool senderAlive );
+	// 'arguments' are those of the sender's destroyed() emission in our thread, or NULL
+	// if the sender died in another thread, before the connection with 'noticeSerial'
+	void senderDestroyed( QObject* sender, void** arguments, co::uint32 noticeSerial );
+
+	// whether the sender has connections that were not notified of its death (the
+	// address of a sender that died in another thread may be reused by a new object)
+	bool hasLiveConnections( QObject* sender ) const;
+
+	// connections to the sender's own destroyed() signals are called right away, whatever
+	// their mode, since they are removed along with the sender (see senderDestroyed())
+	inline bool isDestroyedSignal( int signalIndex ) const
+	{
+		return signalIndex == _destroyedSignalIndex || signalIndex == _destroyedNoArgsSignalIndex;
+	}
+
+	void deliverDestroyed( co::int32 cookie, Connection* c, void** arguments );
+
+	inline int connectionSlot( co::int32 cookie ) const
+	{
+		return _baseId + FIRST_CONNECTION_SLOT + cookie;
+	}
+
+	inline void convertArguments( co::int32 cookie, Connection* c, void** arguments, co::Any* args )
+	{
+		qint64 start = ( _statsEnabled ? _clock.nsecsElapsed() : 0 );
+
+		for( int i = 0; i < c->argCount; ++i )
+			c->converters[i]( c->argTypes[i], arguments[i + 1], args[i] );
+
+		if( _statsEnabled )
+			_stats[cookie].conversionTime += _clock.nsecsElapsed() - start;
+	}
+
+	// records a handler call that took 'time' nanoseconds
+	void recordDispatch( co::int32 cookie, qint64 time );
+
+	void throttle( co::int32 cookie, Connection* c, void** arguments );
+	void enqueue( co::int32 cookie, Connection* c, void** arguments );
+	void unqueue( co::int32 cookie );
+	void flushBatches();
+	void dispatch( co::int32 cookie, Connection* c, const co::Any* args );
+
+	// a signal emission (or sender destruction) queued by another thread
+	struct QueuedEmission
+	{
+		QAtomicPointer<QueuedEmission> next;
+		co::int32 cookie;
+		co::uint32 serial;
+		QObject* destroyedSender; // set for sender destruction notices, which apply to earlier serials
+		int argCount;
+		int argTypes[MAX_ARGS];
+		void* args[MAX_ARGS]; // copies made with QMetaType::construct()
 	};
 
+	// these are called from the emitting threads
+	void postEmission( co::int32 cookie, void** arguments );
+	void postSenderDestroyed( QObject* sender );
+	void post( QueuedEmission* emission );
+
+	void drainQueuedEmissions();
+	static void deleteQueuedEmission( QueuedEmission* emission );
+
+private:
+	co::int32 _baseId;
+	int _destroyedSignalIndex;
+	int _destroyedNoArgsSignalIndex;
 	std::vector<Connection*> _connections;
+	std::vector<co::int32> _freeCookies;
+
+	typedef std::multimap<QObject*, co::int32> SenderMap; // maps senders to their cookies
+	SenderMap _senders;
+
+	typedef std::map<int, co::int32> TimerMap; // maps timer ids to cookies
+	TimerMap _throttleTimers;
+
+	// queue of batched emissions (arguments are stored consecutively)
+	bool _flushPosted;
+	std::vector<co::int32> _batchCookies;
+	std::vector<co::int32> _batchArgCounts;
+	std::vector<co::Any> _batchArgs;
+
+	// cross-thread emissions: other threads take a read lock on _connections and
+	// _senders, which the hub's thread only modifies while holding a write lock
+	QReadWriteLock _connectionsLock;
+	co::uint32 _nextSerial;
+	AtomicQueue<QueuedEmission> _queuedEmissions;
+	QAtomicInt _drainPosted;
+
+	// per-connection statistics, indexed by cookie
+	bool _statsEnabled;
+	std::vector<Stats> _stats;
+	QElapsedTimer _clock;
 };
 
 #endif // _CONNECTIONHUB_H_
@@ -4,6 +4,7 @@
  */
 
 #include "EventHub.h"
+#include <co/IllegalArgumentException.h>
 #include <QEvent>
 #include <QVariant>
 #include <QKeyEvent>
@@ -11,9 +12,17 @@
 #include <QMouseEvent>
 #include <QResizeEvent>
 #include <QCoreApplication>
+#include <QVarLengthArray>
 #include <qt/KeyboardModifiers.h>
+#include <cstring>
 
 QMetaEnum EventHub::sm_qtKeyMetaEnum;
+QHash<int, std::string> EventHub::sm_keyNames;
+
+namespace
+{
+	const QEvent::Type FLUSH_COMPRESSED_EVENT = static_cast<QEvent::Type>( QEvent::registerEventType() );
+}
 
 void EventHub::fillKeyboardModifiers( Qt::KeyboardModifiers modifiers, co::Any& any )
 {
@@ -31,14 +40,34 @@ void EventHub::fillKeyboardModifiers( Qt::KeyboardModifiers modifiers, qt::Keybo
 	km.groupSwitch = modifiers & Qt::GroupSwitchModifier;
 }
 
+const std::string& EventHub::getKeyName( int keyCode )
+{
+	static const std::string s_unknownKey;
+
+	// the names of all keys are interned once
+	if( sm_keyNames.isEmpty() )
+	{
+		if( !sm_qtKeyMetaEnum.isValid() )
+			sm_qtKeyMetaEnum = createKeyMetaEnum();
+
+		int count = sm_qtKeyMetaEnum.keyCount();
+		sm_keyNames.reserve( count );
+		for( int i = 0; i < count; ++i )
+			sm_keyNames.insert( sm_qtKeyMetaEnum.value( i ), sm_qtKeyMetaEnum.key( i ) );
+	}
+
+	QHash<int, std::string>::const_iterator it = sm_keyNames.find( keyCode );
+	return it == sm_keyNames.end() ? s_unknownKey : it.value();
+}
+
 void EventHub::fillKeyCodeString( int keyCode, co::Any& any )
 {
-	const char* name = sm_qtKeyMetaEnum.valueToKey( keyCode );
-	if( name )
+	const std::string& name = getKeyName( keyCode );
+	if( !name.empty() )
 		any.createString() = name;
 }
 
-EventHub::EventHub()
+EventHub::EventHub() : _compressionEnabled( false ), _flushPosted( false )
 {
 	if( !sm_qtKeyMetaEnum.isValid() )
 		sm_qtKeyMetaEnum = createKeyMetaEnum();
@@ -46,48 +75,376 @@ EventHub::EventHub()
 
 EventHub::~EventHub()
 {
-	// empty
+	while( !_filteredObjects.isEmpty() )
+		removeChain( _filteredObjects.begin(), _filteredObjects.begin().key(), true );
 }
 
-co::int64 EventHub::installEventHandler( const qt::Object& watched, qt::IEventHandler* handler )
+co::int64 EventHub::installEventHandler( const qt::Object& watched, qt::IEventHandler* handler,
+										 co::Range<const co::int32> eventTypes, co::int32 priority )
+{
+	return install( watched, handler, NULL, eventTypes, priority );
+}
+
+co::int64 EventHub::installEventRecordHandler( const qt::Object& watched, qt::IEventRecordHandler* handler,
+											   co::Range<const co::int32> eventTypes, co::int32 priority )
+{
+	return install( watched, handler, handler, eventTypes, priority );
+}
+
+co::int64 EventHub::install( const qt::Object& watched, qt::IEventHandler* handler, qt::IEventRecordHandler* recordHandler,
+							 co::Range<const co::int32> eventTypes, co::int32 priority )
 {
 	QObject* obj = watched.get();
-	if( !isObjectFiltered( obj ) )
+	if( !obj )
+		throw co::IllegalArgumentException( "illegal null watched object" );
+
+	if( !handler )
+		throw co::IllegalArgumentException( "illegal null handler" );
+
+	FilteredObjectMap::iterator it = _filteredObjects.find( obj );
+	if( it == _filteredObjects.end() )
+	{
 		obj->installEventFilter( this );
+		QObject::connect( obj, SIGNAL( destroyed( QObject* ) ), this, SLOT( watchedDestroyed( QObject* ) ) );
+		it = _filteredObjects.insert( obj, HandlerChain() );
+	}
+
+	HandlerChain& chain = it.value();
+	size_t count = chain.size();
+	for( size_t i = 0; i < count; ++i )
+	{
+		// extends the subscription of an installed handler
+		if( chain[i].handler.get() == handler )
+		{
+			chain[i].eventTypes.add( eventTypes );
+			return reinterpret_cast<co::int64>( obj );
+		}
+	}
+
+	// handlers with the same priority are called in installation order
+	size_t pos = 0;
+	while( pos < count && chain[pos].priority >= priority )
+		++pos;
 
-	// sets/replaces event handler for the object
-	_filteredObjects[obj] = handler;
+	Subscription& s = *chain.insert( chain.begin() + pos, Subscription() );
+	s.handler = handler;
+	s.recordHandler = recordHandler;
+	s.priority = priority;
+	s.eventTypes.add( eventTypes );
 
 	return reinterpret_cast<co::int64>( obj );
 }
 
-void EventHub::removeEventHandler( const qt::Object& watched )
+void EventHub::removeEventHandler( const qt::Object& watched, qt::IEventHandler* handler )
 {
 	QObject* obj = watched.get();
-	if( isObjectFiltered( obj ) )
+	FilteredObjectMap::iterator it = _filteredObjects.find( obj );
+	if( it == _filteredObjects.end() )
+		return;
+
+	HandlerChain& chain = it.value();
+	if( handler )
+	{
+		for( HandlerChain::iterator si = chain.begin(); si != chain.end(); ++si )
+		{
+			if( si->handler.get() == handler )
+			{
+				chain.erase( si );
+				break;
+			}
+		}
+	}
+
+	if( !handler || chain.empty() )
+		removeChain( it, obj, true );
+}
+
+void EventHub::removeChain( FilteredObjectMap::iterator it, QObject* watched, bool watchedAlive )
+{
+	if( watchedAlive )
 	{
-		obj->removeEventFilter( this );
-		_filteredObjects.erase( obj );
+		watched->removeEventFilter( this );
+		QObject::disconnect( watched, SIGNAL( destroyed( QObject* ) ), this, SLOT( watchedDestroyed( QObject* ) ) );
 	}
+
+	_filteredObjects.erase( it );
+	_compressed.remove( watched );
+}
+
+void EventHub::watchedDestroyed( QObject* watched )
+{
+	FilteredObjectMap::iterator it = _filteredObjects.find( watched );
+	if( it == _filteredObjects.end() )
+		return;
+
+	// the handlers must forget the cookie, since it may be reused by a new object
+	HandlerChain chain;
+	chain.swap( it.value() );
+	removeChain( it, watched, false );
+
+	co::int64 cookie = reinterpret_cast<co::int64>( watched );
+	size_t count = chain.size();
+	for( size_t i = 0; i < count; ++i )
+		chain[i].handler->onObjectDestroyed( cookie );
+}
+
+void EventHub::setCompressionEnabled( bool enabled )
+{
+	_compressionEnabled = enabled;
+	if( !enabled )
+		flushAllCompressed();
 }
 
 bool EventHub::eventFilter( QObject* watched, QEvent* event )
 {
-	assert( _filteredObjects[watched] );
+	if( _compressionEnabled && compressEvent( watched, event ) )
+		return false;
+
+	// events must not overtake the compressed events pending for their object
+	if( !_compressed.isEmpty() )
+		flushCompressed( watched );
+
+	return dispatchEvent( watched, event );
+}
+
+void EventHub::customEvent( QEvent* e )
+{
+	if( e->type() == FLUSH_COMPRESSED_EVENT )
+		flushAllCompressed();
+	else
+		QObject::customEvent( e );
+}
+
+bool EventHub::dispatchEvent( QObject* watched, QEvent* event )
+{
+	FilteredObjectMap::iterator it = _filteredObjects.find( watched );
+	if( it == _filteredObjects.end() )
+		return false;
 
+	// skip events no handler is interested in before doing any work
+	int type = event->type();
+	const HandlerChain& chain = it.value();
+	size_t count = chain.size();
+	size_t first = 0;
+	while( first < count && !chain[first].accepts( type ) )
+		++first;
+
+	if( first == count )
+		return false;
+
+	// handlers may change the chain while it is dispatched, so keep them alive in a local copy
+	QVarLengthArray<co::RefPtr<qt::IEventHandler>, INLINE_CHAIN_DISPATCH> handlers;
+	QVarLengthArray<qt::IEventRecordHandler*, INLINE_CHAIN_DISPATCH> recordHandlers;
+	for( size_t i = first; i < count; ++i )
+	{
+		if( chain[i].accepts( type ) )
+		{
+			handlers.append( chain[i].handler );
+			recordHandlers.append( chain[i].recordHandler );
+		}
+	}
+
+	// arguments are converted on demand, in the representation each handler expects
 	co::Any args[MAX_ARGS];
-	extractArguments( event, args, MAX_ARGS );
-
-	if( !_filteredObjects[watched]->onEvent( reinterpret_cast<co::int64>( watched ), event->type(),
-										args[0], args[1], args[2], args[3], args[4], args[5] ) )
-    {
-        event->ignore();
-        return true;
-    }
-    
+	bool hasArgs = false;
+	qt::EventRecord record;
+	bool hasRecord = false;
+
+	co::int64 cookie = reinterpret_cast<co::int64>( watched );
+	int dispatched = handlers.size();
+	for( int i = 0; i < dispatched; ++i )
+	{
+		bool accepted;
+		if( recordHandlers[i] )
+		{
+			if( !hasRecord )
+			{
+				fillEventRecord( event, record );
+				hasRecord = true;
+			}
+			accepted = recordHandlers[i]->onEventRecord( cookie, record );
+		}
+		else
+		{
+			if( !hasArgs )
+			{
+				extractArguments( event, args, MAX_ARGS );
+				hasArgs = true;
+			}
+			accepted = handlers[i]->onEvent( cookie, type, args[0], args[1], args[2], args[3], args[4], args[5] );
+		}
+
+		if( !accepted )
+		{
+			event->ignore();
+			return true;
+		}
+	}
+
 	return false;
 }
 
+bool EventHub::compressEvent( QObject* watched, QEvent* event )
+{
+	QEvent::Type type = event->type();
+	if( type != QEvent::MouseMove && type != QEvent::Wheel && type != QEvent::Resize )
+		return false;
+
+	// only compress events some handler is interested in
+	FilteredObjectMap::iterator it = _filteredObjects.find( watched );
+	if( it == _filteredObjects.end() )
+		return false;
+
+	const HandlerChain& chain = it.value();
+	size_t count = chain.size();
+	size_t i = 0;
+	while( i < count && !chain[i].accepts( type ) )
+		++i;
+
+	if( i == count )
+		return false;
+
+	int flag = ( type == QEvent::MouseMove ? COMPRESSED_MOUSE_MOVE :
+				( type == QEvent::Wheel ? COMPRESSED_WHEEL : COMPRESSED_RESIZE ) );
+
+	// events are only merged into the latest pending event, so they are not reordered
+	// (e.g. MouseMove, Wheel, MouseMove); wheel deltas of different orientations cannot be summed
+	CompressedEventsMap::iterator ci = _compressed.find( watched );
+	if( ci != _compressed.end() && ( ci.value().types & flag ) &&
+		( ci.value().order[ci.value().orderCount - 1] != flag || ( type == QEvent::Wheel &&
+		  ci.value().wheelOrientation != static_cast<QWheelEvent*>( event )->orientation() ) ) )
+	{
+		flushCompressed( watched );
+		ci = _compressed.end();
+	}
+
+	if( ci == _compressed.end() )
+	{
+		ci = _compressed.insert( watched, CompressedEvents() );
+		ci.value().types = 0;
+		ci.value().orderCount = 0;
+	}
+
+	CompressedEvents& pending = ci.value();
+	if( !( pending.types & flag ) )
+		pending.order[pending.orderCount++] = flag;
+
+	if( type == QEvent::MouseMove )
+	{
+		QMouseEvent* mouseEvent = static_cast<QMouseEvent*>( event );
+		pending.types |= COMPRESSED_MOUSE_MOVE;
+		pending.movePos = mouseEvent->pos();
+		pending.moveButtons = mouseEvent->buttons();
+		pending.moveModifiers = mouseEvent->modifiers();
+	}
+	else if( type == QEvent::Wheel )
+	{
+		QWheelEvent* wheelEvent = static_cast<QWheelEvent*>( event );
+		if( !( pending.types & COMPRESSED_WHEEL ) )
+		{
+			pending.types |= COMPRESSED_WHEEL;
+			pending.wheelDelta = 0;
+			pending.wheelOrientation = wheelEvent->orientation();
+		}
+		pending.wheelPos = wheelEvent->pos();
+		pending.wheelDelta += wheelEvent->delta();
+		pending.wheelButtons = wheelEvent->buttons();
+		pending.wheelModifiers = wheelEvent->modifiers();
+	}
+	else
+	{
+		QResizeEvent* resizeEvent = static_cast<QResizeEvent*>( event );
+		if( !( pending.types & COMPRESSED_RESIZE ) )
+		{
+			pending.types |= COMPRESSED_RESIZE;
+			pending.oldSize = resizeEvent->oldSize();
+		}
+		pending.size = resizeEvent->size();
+	}
+
+	// schedule a flush for the next event loop iteration
+	if( !_flushPosted )
+	{
+		_flushPosted = true;
+		QCoreApplication::postEvent( this, new QEvent( FLUSH_COMPRESSED_EVENT ) );
+	}
+
+	return true;
+}
+
+void EventHub::flushCompressed( QObject* watched )
+{
+	CompressedEventsMap::iterator it = _compressed.find( watched );
+	if( it == _compressed.end() )
+		return;
+
+	CompressedEvents pending = it.value();
+	_compressed.erase( it );
+	dispatchCompressed( watched, pending );
+}
+
+void EventHub::flushAllCompressed()
+{
+	_flushPosted = false;
+
+	// objects may be destroyed (and events compressed) while we dispatch
+	QList<QObject*> objects = _compressed.keys();
+	int count = objects.count();
+	for( int i = 0; i < count; ++i )
+		flushCompressed( objects[i] );
+}
+
+void EventHub::dispatchCompressed( QObject* watched, const CompressedEvents& pending )
+{
+	// merged events are dispatched in arrival order, and cannot be consumed
+	for( int i = 0; i < pending.orderCount; ++i )
+	{
+		if( pending.order[i] == COMPRESSED_RESIZE )
+		{
+			QResizeEvent resizeEvent( pending.size, pending.oldSize );
+			dispatchEvent( watched, &resizeEvent );
+		}
+		else if( pending.order[i] == COMPRESSED_MOUSE_MOVE )
+		{
+			QMouseEvent mouseEvent( QEvent::MouseMove, pending.movePos, Qt::NoButton,
+									pending.moveButtons, pending.moveModifiers );
+			dispatchEvent( watched, &mouseEvent );
+		}
+		else
+		{
+			QWheelEvent wheelEvent( pending.wheelPos, pending.wheelDelta, pending.wheelButtons,
+									pending.wheelModifiers, pending.wheelOrientation );
+			dispatchEvent( watched, &wheelEvent );
+		}
+	}
+}
+
+QEvent* EventHub::createEvent( const qt::EventRecord& record )
+{
+	QEvent::Type ev = static_cast<QEvent::Type>( record.type );
+	QPoint pos( record.x, record.y );
+	Qt::KeyboardModifiers modifiers( record.modifiers );
+	Qt::MouseButtons buttons( record.buttons );
+	switch( ev )
+	{
+	case QEvent::MouseButtonDblClick:
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+		return new QMouseEvent( ev, pos, static_cast<Qt::MouseButton>( record.buttons ), buttons, modifiers );
+	case QEvent::MouseMove:
+		return new QMouseEvent( ev, pos, Qt::NoButton, buttons, modifiers );
+	case QEvent::KeyPress:
+	case QEvent::KeyRelease:
+		return new QKeyEvent( ev, record.key, modifiers );
+	case QEvent::Wheel:
+		return new QWheelEvent( pos, record.delta, buttons, modifiers );
+	case QEvent::Resize:
+		return new QResizeEvent( QSize( record.width, record.height ), QSize( record.oldWidth, record.oldHeight ) );
+	default:
+		return NULL;
+	}
+}
+
 // Extract event-specific arguments to co::Any array
 void EventHub::extractArguments( QEvent* event, co::Any* args, int maxArgs )
 {
@@ -125,7 +482,7 @@ void EventHub::extractArguments( QEvent* event, co::Any* args, int maxArgs )
 			// extract position (x and y ), delta, modifiers
 			const QPoint& pos = wheelEvent->pos();
 			args[0].set( pos.x() );
-			args[1].set( pos.x() );
+			args[1].set( pos.y() );
 			args[2].set( wheelEvent->delta() );
 			fillKeyboardModifiers( wheelEvent->modifiers(), args[3] );
 		}
@@ -149,9 +506,60 @@ void EventHub::extractArguments( QEvent* event, co::Any* args, int maxArgs )
 	}
 }
 
-bool EventHub::isObjectFiltered( QObject* watched )
+void EventHub::fillEventRecord( QEvent* event, qt::EventRecord& record )
 {
-	return _filteredObjects.find( watched ) != _filteredObjects.end();
+	memset( &record, 0, sizeof(record) );
+
+	QEvent::Type ev = event->type();
+	record.type = ev;
+	switch( ev )
+	{
+	case QEvent::MouseButtonDblClick:
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	case QEvent::MouseMove:
+		{
+			QMouseEvent* mouseEvent = static_cast<QMouseEvent*>( event );
+			const QPoint& pos = mouseEvent->pos();
+			record.x = pos.x();
+			record.y = pos.y();
+			record.buttons = ( ev == QEvent::MouseMove ? mouseEvent->buttons() : mouseEvent->button() );
+			record.modifiers = mouseEvent->modifiers();
+		}
+		break;
+	case QEvent::KeyPress:
+	case QEvent::KeyRelease:
+		{
+			QKeyEvent* keyEvent = static_cast<QKeyEvent*>( event );
+			record.key = keyEvent->key();
+			record.modifiers = keyEvent->modifiers();
+		}
+		break;
+	case QEvent::Wheel:
+		{
+			QWheelEvent* wheelEvent = static_cast<QWheelEvent*>( event );
+			const QPoint& pos = wheelEvent->pos();
+			record.x = pos.x();
+			record.y = pos.y();
+			record.delta = wheelEvent->delta();
+			record.buttons = wheelEvent->buttons();
+			record.modifiers = wheelEvent->modifiers();
+		}
+		break;
+	case QEvent::Resize:
+		{
+			QResizeEvent* resizeEvent = static_cast<QResizeEvent*>( event );
+			const QSize& size = resizeEvent->size();
+			const QSize& oldSize = resizeEvent->oldSize();
+			record.width = size.width();
+			record.height = size.height();
+			record.oldWidth = oldSize.width();
+			record.oldHeight = oldSize.height();
+		}
+		break;
+	default:
+		break;
+	}
 }
 
 QMetaEnum EventHub::createKeyMetaEnum()
@@ -6,26 +6,52 @@
 #ifndef _EVENTHUB_H_
 #define _EVENTHUB_H_
 
+#include <QHash>
+#include <QSize>
+#include <QPoint>
 #include <QMetaEnum>
+#include <co/RefPtr.h>
 #include <qt/Object.h>
 #include <qt/IEventHandler.h>
+#include <qt/IEventRecordHandler.h>
+#include <qt/EventRecord.h>
 #include <qt/KeyboardModifiers.h>
 
-#include <map>
+#include "EventTypeSet.h"
+#include <vector>
 
 /*!
 	A QObject for dispatching events to IEventHandlers.
+	Each watched object has a chain of handlers, called in priority order.
+	Handlers are released automatically when their watched object is destroyed.
  */
 class EventHub : public QObject
 {
-	Q_GADGET
+	Q_OBJECT
 	Q_PROPERTY( Qt::Key _qtKeyEnum READ getKeyEnum )
 
 public:
+	//! Returns the interned name of a Qt::Key code (e.g. "Key_A"), or an empty string if unknown.
+	static const std::string& getKeyName( int keyCode );
+
 	static void fillKeyCodeString( int keyCode, co::Any& any );
 	static void fillKeyboardModifiers( Qt::KeyboardModifiers modifiers, co::Any& any );
 	static void fillKeyboardModifiers( Qt::KeyboardModifiers modifiers, qt::KeyboardModifiers& km );
 
+	static const int MAX_ARGS = 6;
+
+	//! Converts the event-specific arguments of \a event into \a args.
+	static void extractArguments( QEvent* event, co::Any* args, int maxArgs );
+
+	//! Fills the compact \a record of \a event.
+	static void fillEventRecord( QEvent* event, qt::EventRecord& record );
+
+	/*!
+		Creates the event described by \a record (the reverse of fillEventRecord()).
+		Returns NULL if the event type is not a mouse, key, wheel or resize event.
+	 */
+	static QEvent* createEvent( const qt::EventRecord& record );
+
 public:
 	//! Accessor for qt property (necessary to avoid Qt warnings)
 	Qt::Key getKeyEnum() { return _qtKeyEnum; }
@@ -38,27 +64,108 @@ public:
 	/*!
 		Installs an event handler into \a watched object. The installation is
 		identified by a \a cookie, which is returned as the method's result.
+		The handler is only notified of events whose types are in \a eventTypes
+		(or of all events, if \a eventTypes is empty). Installing the same handler
+		again adds \a eventTypes to its subscription. Handlers with higher
+		\a priority are called first; a handler that returns false stops the chain.
+	 */
+	co::int64 installEventHandler( const qt::Object& watched, qt::IEventHandler* handler,
+								   co::Range<const co::int32> eventTypes, co::int32 priority );
+
+	/*!
+		Removes \a handler from the chain of \a watched object, or all
+		handlers if \a handler is null.
 	 */
-	co::int64 installEventHandler( const qt::Object& watched, qt::IEventHandler* handler );
+	void removeEventHandler( const qt::Object& watched, qt::IEventHandler* handler );
 
-	//! Removes \a watched object from filtered objects list
-	void removeEventHandler( const qt::Object& watched );
+	//! Same as installEventHandler(), but \a handler receives compact event records.
+	co::int64 installEventRecordHandler( const qt::Object& watched, qt::IEventRecordHandler* handler,
+										 co::Range<const co::int32> eventTypes, co::int32 priority );
+
+	/*!
+		Enables or disables event compression. While enabled, consecutive MouseMove,
+		Wheel and Resize events of a watched object are merged (latest position, summed
+		wheel delta, final size) and dispatched at most once per event loop iteration.
+		Handlers cannot consume compressed events, which always reach their object.
+	 */
+	void setCompressionEnabled( bool enabled );
+
+	inline bool getCompressionEnabled() const { return _compressionEnabled; }
 
 protected:
 	virtual bool eventFilter( QObject* watched, QEvent* event );
 
+	//! Dispatches the compressed events.
+	void customEvent( QEvent* e );
+
+private slots:
+	void watchedDestroyed( QObject* watched );
+
 private:
-	// returns whether the given object is already filtered.
-	void extractArguments( QEvent* event, co::Any* args, int maxArgs );
-	bool isObjectFiltered( QObject* watched );
 	static QMetaEnum createKeyMetaEnum();
 
 private:
 	Qt::Key _qtKeyEnum;
 	static QMetaEnum sm_qtKeyMetaEnum;
-	static const int MAX_ARGS = 6;
-	typedef std::map<QObject*, qt::IEventHandler*> FilteredObjectMap;
+	static QHash<int, std::string> sm_keyNames; // interned Qt::Key names
+	static const int INLINE_CHAIN_DISPATCH = 16; // handlers per event copied without allocating
+
+	// a handler and the set of event types it is notified of
+	struct Subscription
+	{
+		co::RefPtr<qt::IEventHandler> handler;
+		qt::IEventRecordHandler* recordHandler; // same as handler for record handlers, NULL otherwise
+		co::int32 priority;
+		EventTypeSet eventTypes;
+
+		inline bool accepts( int type ) const { return eventTypes.contains( type ); }
+	};
+
+	// chain of handlers of a watched object, sorted by decreasing priority
+	typedef std::vector<Subscription> HandlerChain;
+	typedef QHash<QObject*, HandlerChain> FilteredObjectMap;
+
+	co::int64 install( const qt::Object& watched, qt::IEventHandler* handler, qt::IEventRecordHandler* recordHandler,
+					   co::Range<const co::int32> eventTypes, co::int32 priority );
+	void removeChain( FilteredObjectMap::iterator it, QObject* watched, bool watchedAlive );
+
+	// calls the handlers of the watched object; returns whether the event was consumed
+	bool dispatchEvent( QObject* watched, QEvent* event );
+
+	// merged events pending for a watched object
+	enum CompressedType
+	{
+		COMPRESSED_RESIZE		= 1 << 0,
+		COMPRESSED_MOUSE_MOVE	= 1 << 1,
+		COMPRESSED_WHEEL		= 1 << 2
+	};
+
+	struct CompressedEvents
+	{
+		int types; // mask of CompressedType flags
+		int order[3]; // CompressedType flags in arrival order
+		int orderCount;
+		QSize size, oldSize; // oldSize comes from the first resize
+		QPoint movePos;
+		Qt::MouseButtons moveButtons;
+		Qt::KeyboardModifiers moveModifiers;
+		QPoint wheelPos;
+		int wheelDelta; // sum of all deltas
+		Qt::MouseButtons wheelButtons;
+		Qt::KeyboardModifiers wheelModifiers;
+		Qt::Orientation wheelOrientation;
+	};
+
+	bool compressEvent( QObject* watched, QEvent* event );
+	void flushCompressed( QObject* watched );
+	void flushAllCompressed();
+	void dispatchCompressed( QObject* watched, const CompressedEvents& pending );
 	FilteredObjectMap _filteredObjects;
+
+	bool _compressionEnabled;
+	bool _flushPosted;
+	typedef QHash<QObject*, CompressedEvents> CompressedEventsMap;
+	CompressedEventsMap _compressed;
 };
 
 #endif // _EVENTHUB_H_
@@ -0,0 +1,155 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "EventRouter.h"
+#include "EventHub.h"
+#include "StringBridge.h"
+#include <co/IllegalArgumentException.h>
+#include <QCoreApplication>
+#include <QEvent>
+
+EventRouter::EventRouter() : _routeCount( 0 )
+{
+	// empty
+}
+
+EventRouter::~EventRouter()
+{
+	size_t count = _routes.size();
+	for( size_t i = 0; i < count; ++i )
+		delete _routes[i];
+}
+
+co::int32 EventRouter::addRoute( const qt::Object& root, const std::string& className,
+								 const std::string& objectNamePattern, co::Range<const co::int32> eventTypes,
+								 qt::IDelegatedEventHandler* handler )
+{
+	if( !handler )
+		throw co::IllegalArgumentException( "illegal null handler" );
+
+	QRegExp pattern( toQString( objectNamePattern ), Qt::CaseSensitive, QRegExp::Wildcard );
+	if( !pattern.isValid() )
+		throw co::IllegalArgumentException( "invalid objectName pattern" );
+
+	Route* r = new Route;
+	QObject* rootObj = root.get();
+	r->hasRoot = ( rootObj != NULL && rootObj != QCoreApplication::instance() );
+	r->root = rootObj;
+	r->className = className.c_str();
+	r->objectNamePattern = pattern;
+	r->eventTypes.add( eventTypes );
+	r->handler = handler;
+
+	// reuse the id of a removed route, if any
+	co::int32 route;
+	if( _freeRoutes.empty() )
+	{
+		route = static_cast<co::int32>( _routes.size() );
+		_routes.push_back( r );
+	}
+	else
+	{
+		route = _freeRoutes.back();
+		_freeRoutes.pop_back();
+		_routes[route] = r;
+	}
+
+	// the application filter is only installed while there are routes
+	if( _routeCount++ == 0 )
+		QCoreApplication::instance()->installEventFilter( this );
+
+	_eventTypes.add( r->eventTypes );
+
+	return route;
+}
+
+void EventRouter::removeRoute( co::int32 route )
+{
+	if( route < 0 || route >= static_cast<co::int32>( _routes.size() ) || !_routes[route] )
+		throw co::IllegalArgumentException( "invalid route" );
+
+	delete _routes[route];
+	_routes[route] = NULL;
+	_freeRoutes.push_back( route );
+
+	if( --_routeCount == 0 )
+		QCoreApplication::instance()->removeEventFilter( this );
+
+	updateEventTypes();
+}
+
+bool EventRouter::eventFilter( QObject* watched, QEvent* event )
+{
+	// this filter sees every event in the application, so reject most of them right away
+	int type = event->type();
+	if( !_eventTypes.contains( type ) )
+		return false;
+
+	co::Any args[EventHub::MAX_ARGS];
+	bool extracted = false;
+	qt::Object watchedObj;
+
+	// routes may be added or removed by the handlers
+	for( size_t i = 0; i < _routes.size(); ++i )
+	{
+		Route* r = _routes[i];
+		if( !r || !r->eventTypes.contains( type ) || !matches( r, watched ) )
+			continue;
+
+		if( !extracted )
+		{
+			EventHub::extractArguments( event, args, EventHub::MAX_ARGS );
+			watchedObj.set( watched );
+			extracted = true;
+		}
+
+		co::RefPtr<qt::IDelegatedEventHandler> handler( r->handler );
+		if( !handler->onDelegatedEvent( static_cast<co::int32>( i ), watchedObj, type,
+										args[0], args[1], args[2], args[3], args[4], args[5] ) )
+		{
+			event->ignore();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool EventRouter::matches( const Route* r, QObject* watched ) const
+{
+	if( !r->className.isEmpty() && !watched->inherits( r->className.constData() ) )
+		return false;
+
+	if( !r->objectNamePattern.isEmpty() && !r->objectNamePattern.exactMatch( watched->objectName() ) )
+		return false;
+
+	if( r->hasRoot )
+	{
+		QObject* root = r->root;
+		if( !root )
+			return false;
+
+		// matches the root and all of its descendants
+		QObject* obj = watched;
+		while( obj && obj != root )
+			obj = obj->parent();
+
+		if( !obj )
+			return false;
+	}
+
+	return true;
+}
+
+void EventRouter::updateEventTypes()
+{
+	_eventTypes.clear();
+	size_t count = _routes.size();
+	for( size_t i = 0; i < count; ++i )
+	{
+		if( _routes[i] )
+			_eventTypes.add( _routes[i]->eventTypes );
+	}
+}
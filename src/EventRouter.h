@@ -0,0 +1,68 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _EVENTROUTER_H_
+#define _EVENTROUTER_H_
+
+#include "EventTypeSet.h"
+#include <co/RefPtr.h>
+#include <qt/Object.h>
+#include <qt/IDelegatedEventHandler.h>
+#include <QObject>
+#include <QPointer>
+#include <QRegExp>
+#include <vector>
+
+/*!
+	Delegates events of whole groups of objects to IDelegatedEventHandlers, through
+	a single event filter installed in the application (instead of one per object).
+	Objects are matched by ancestor, class name and objectName pattern, including
+	objects created after the route was added.
+ */
+class EventRouter : public QObject
+{
+public:
+	EventRouter();
+
+	virtual ~EventRouter();
+
+	/*!
+		Adds a route that delegates the events whose types are in \a eventTypes
+		(all events if empty) to the given \a handler. Empty criteria (or qApp as
+		\a root) match all objects.
+		Returns the route's identifier.
+	 */
+	co::int32 addRoute( const qt::Object& root, const std::string& className,
+						const std::string& objectNamePattern, co::Range<const co::int32> eventTypes,
+						qt::IDelegatedEventHandler* handler );
+
+	//! Removes the route identified by the given \a route id.
+	void removeRoute( co::int32 route );
+
+protected:
+	virtual bool eventFilter( QObject* watched, QEvent* event );
+
+private:
+	struct Route
+	{
+		bool hasRoot;
+		QPointer<QObject> root; // becomes null (and stops matching) if the root is destroyed
+		QByteArray className;
+		QRegExp objectNamePattern; // empty pattern matches any name
+		EventTypeSet eventTypes;
+		co::RefPtr<qt::IDelegatedEventHandler> handler;
+	};
+
+	bool matches( const Route* r, QObject* watched ) const;
+	void updateEventTypes();
+
+private:
+	std::vector<Route*> _routes; // indexed by route id (NULL for removed routes)
+	std::vector<co::int32> _freeRoutes;
+	int _routeCount;
+	EventTypeSet _eventTypes; // union of the event types of all routes
+};
+
+#endif // _EVENTROUTER_H_
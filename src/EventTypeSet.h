@@ -0,0 +1,80 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _EVENTTYPESET_H_
+#define _EVENTTYPESET_H_
+
+#include <co/Range.h>
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/*!
+	A set of QEvent types, optimized for membership tests on every event.
+	Built-in event types are kept in a bit mask, others in a sorted list.
+	An empty list of types passed to add() means all event types.
+ */
+class EventTypeSet
+{
+public:
+	EventTypeSet()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		_allEvents = false;
+		memset( _mask, 0, sizeof(_mask) );
+		_otherTypes.clear();
+	}
+
+	void add( co::Range<const co::int32> eventTypes )
+	{
+		if( eventTypes.isEmpty() )
+			_allEvents = true;
+
+		for( ; eventTypes; eventTypes.popFirst() )
+			add( eventTypes.getFirst() );
+	}
+
+	void add( int type )
+	{
+		if( type >= 0 && type < MASK_TYPES )
+			_mask[type >> 5] |= ( 1u << ( type & 31 ) );
+		else if( !std::binary_search( _otherTypes.begin(), _otherTypes.end(), type ) )
+			_otherTypes.insert( std::lower_bound( _otherTypes.begin(), _otherTypes.end(), type ), type );
+	}
+
+	//! Adds all types of the \a other set.
+	void add( const EventTypeSet& other )
+	{
+		_allEvents = _allEvents || other._allEvents;
+		for( int i = 0; i < MASK_WORDS; ++i )
+			_mask[i] |= other._mask[i];
+		for( size_t i = 0; i < other._otherTypes.size(); ++i )
+			add( other._otherTypes[i] );
+	}
+
+	inline bool contains( int type ) const
+	{
+		if( _allEvents )
+			return true;
+		if( type >= 0 && type < MASK_TYPES )
+			return ( _mask[type >> 5] & ( 1u << ( type & 31 ) ) ) != 0;
+		return std::binary_search( _otherTypes.begin(), _otherTypes.end(), type );
+	}
+
+private:
+	static const int MASK_TYPES = 256;
+	static const int MASK_WORDS = MASK_TYPES / 32;
+
+	bool _allEvents;
+	quint32 _mask[MASK_WORDS];
+	std::vector<int> _otherTypes;
+};
+
+#endif // _EVENTTYPESET_H_
@@ -1,5 +1,6 @@
 #include "GLWidget.h"
 #include "EventHub.h"
+#include "StringBridge.h"
 #include <qt/IPainter.h>
 #include <QKeyEvent>
 #include <QMouseEvent>
@@ -89,10 +90,7 @@ void GLWidget::keyPressEvent( QKeyEvent* event )
 	qt::KeyboardModifiers km;
 	EventHub::fillKeyboardModifiers( event->modifiers(), km );
 
-	co::Any keyCode;
-	EventHub::fillKeyCodeString( event->key(), keyCode );
-
-	_inputListener->keyPressed( keyCode.get<std::string&>(), event->text().toStdString(), km );
+	_inputListener->keyPressed( EventHub::getKeyName( event->key() ), toUtf8String( event->text() ), km );
 }
 
 void GLWidget::keyReleaseEvent( QKeyEvent* event )
@@ -106,10 +104,7 @@ void GLWidget::keyReleaseEvent( QKeyEvent* event )
 	qt::KeyboardModifiers km;
 	EventHub::fillKeyboardModifiers( event->modifiers(), km );
 
-	co::Any keyCode;
-	EventHub::fillKeyCodeString( event->key(), keyCode );
-
-	_inputListener->keyReleased( keyCode.get<std::string&>(), event->text().toStdString(), km );
+	_inputListener->keyReleased( EventHub::getKeyName( event->key() ), toUtf8String( event->text() ), km );
 }
 
 void GLWidget::mousePressEvent( QMouseEvent* event )
@@ -0,0 +1,153 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "ItemDataCache.h"
+#include <limits>
+
+ItemDataCache::ItemDataCache() : _capacity( 0 )
+{
+	// empty
+}
+
+void ItemDataCache::setCapacity( int capacity )
+{
+	_capacity = capacity;
+	clear();
+}
+
+bool ItemDataCache::find( co::int32 id, int role, QVariant& value )
+{
+	Item* item = findItem( id );
+	if( !item )
+		return false;
+
+	int count = item->values.size();
+	for( int i = 0; i < count; ++i )
+	{
+		if( item->values[i].first == role )
+		{
+			value = item->values[i].second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ItemDataCache::insert( co::int32 id, int role, const QVariant& value )
+{
+	Item& item = getItem( id );
+
+	int count = item.values.size();
+	for( int i = 0; i < count; ++i )
+	{
+		if( item.values[i].first == role )
+		{
+			item.values[i].second = value;
+			return;
+		}
+	}
+
+	item.values.append( qMakePair( role, value ) );
+}
+
+void ItemDataCache::setPosition( co::int32 id, co::int32 parentId, int row, int column )
+{
+	Item& item = getItem( id );
+	if( item.hasPosition && ( item.parentId != parentId || item.row != row || item.column != column ) )
+		item.values.clear(); // the delegate reused the id for another item
+
+	item.hasPosition = true;
+	item.parentId = parentId;
+	item.row = row;
+	item.column = column;
+}
+
+void ItemDataCache::removeItem( co::int32 id )
+{
+	_recent.remove( id );
+	_old.remove( id );
+}
+
+void ItemDataCache::removeRange( co::int32 parentId, int firstRow, int lastRow, int firstColumn, int lastColumn )
+{
+	removeMatching( parentId, firstRow, lastRow, firstColumn, lastColumn );
+}
+
+void ItemDataCache::removeRowsFrom( co::int32 parentId, int firstRow )
+{
+	removeMatching( parentId, firstRow, std::numeric_limits<int>::max(), 0, std::numeric_limits<int>::max() );
+}
+
+void ItemDataCache::removeColumnsFrom( co::int32 parentId, int firstColumn )
+{
+	removeMatching( parentId, 0, std::numeric_limits<int>::max(), firstColumn, std::numeric_limits<int>::max() );
+}
+
+void ItemDataCache::clear()
+{
+	_recent.clear();
+	_old.clear();
+}
+
+ItemDataCache::Item* ItemDataCache::findItem( co::int32 id )
+{
+	ItemMap::iterator it = _recent.find( id );
+	if( it != _recent.end() )
+		return &it.value();
+
+	it = _old.find( id );
+	if( it == _old.end() )
+		return NULL;
+
+	// promote the item to the recent generation (which may start a new generation)
+	Item promoted = it.value();
+	_old.erase( it );
+	Item& item = addItem( id );
+	item = promoted;
+	return &item;
+}
+
+ItemDataCache::Item& ItemDataCache::getItem( co::int32 id )
+{
+	Item* item = findItem( id );
+	return item ? *item : addItem( id );
+}
+
+ItemDataCache::Item& ItemDataCache::addItem( co::int32 id )
+{
+	// start a new generation when the recent one is full
+	if( _capacity > 0 && _recent.size() >= ( _capacity + 1 ) / 2 )
+	{
+		_old.swap( _recent );
+		_recent.clear();
+	}
+
+	Item& item = _recent[id];
+	item.hasPosition = false;
+	return item;
+}
+
+void ItemDataCache::removeMatching( co::int32 parentId, int firstRow, int lastRow, int firstColumn, int lastColumn )
+{
+	removeMatching( _recent, parentId, firstRow, lastRow, firstColumn, lastColumn );
+	removeMatching( _old, parentId, firstRow, lastRow, firstColumn, lastColumn );
+}
+
+void ItemDataCache::removeMatching( ItemMap& map, co::int32 parentId, int firstRow, int lastRow, int firstColumn, int lastColumn )
+{
+	ItemMap::iterator it = map.begin();
+	while( it != map.end() )
+	{
+		const Item& item = it.value();
+		bool matches = !item.hasPosition || ( item.parentId == parentId &&
+						item.row >= firstRow && item.row <= lastRow &&
+						item.column >= firstColumn && item.column <= lastColumn );
+		if( matches )
+			it = map.erase( it );
+		else
+			++it;
+	}
+}
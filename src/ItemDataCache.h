@@ -0,0 +1,92 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _ITEMDATACACHE_H_
+#define _ITEMDATACACHE_H_
+
+#include <co/Platform.h>
+#include <QVarLengthArray>
+#include <QVariant>
+#include <QHash>
+
+/*!
+	Cache of item data converted to QVariants, keyed by (internal id, role).
+	Null variants are cached as well, so that missing data is not requested again.
+
+	The cache may be bounded to a number of items. It then keeps two generations
+	of items: when the recent generation is full, it replaces the old one, and
+	items found in the old generation are promoted back (an approximate LRU).
+
+	Items may also record their position (parent id, row and column), so that
+	structural changes only invalidate the affected items. Items with unknown
+	positions are invalidated by any structural change, and the data of an item
+	found at another position is dropped (its id was reused for another item).
+ */
+class ItemDataCache
+{
+public:
+	ItemDataCache();
+
+	//! Maximum number of items in the cache (0 for unbounded).
+	void setCapacity( int capacity );
+
+	inline int getCapacity() const { return _capacity; }
+
+	//! Returns whether the data of \a id for \a role is cached, and copies it into \a value.
+	bool find( co::int32 id, int role, QVariant& value );
+
+	void insert( co::int32 id, int role, const QVariant& value );
+
+	//! Records the position of item \a id, dropping its data if it was cached at another position.
+	void setPosition( co::int32 id, co::int32 parentId, int row, int column );
+
+	//! Invalidates the data of item \a id.
+	void removeItem( co::int32 id );
+
+	//! Invalidates the items of \a parentId within the given rows and columns.
+	void removeRange( co::int32 parentId, int firstRow, int lastRow, int firstColumn, int lastColumn );
+
+	//! Invalidates the items of \a parentId from \a firstRow on (i.e. the rows moved by an insertion or removal).
+	void removeRowsFrom( co::int32 parentId, int firstRow );
+
+	//! Invalidates the items of \a parentId from \a firstColumn on.
+	void removeColumnsFrom( co::int32 parentId, int firstColumn );
+
+	inline bool isEmpty() const { return _recent.isEmpty() && _old.isEmpty(); }
+
+	void clear();
+
+private:
+	struct Item
+	{
+		bool hasPosition;
+		co::int32 parentId;
+		int row;
+		int column;
+		QVarLengthArray<QPair<int, QVariant>, 8> values; // (role, data) pairs
+	};
+
+	typedef QHash<co::int32, Item> ItemMap;
+
+	// returns the recent item with the given id (promoting it from the old generation), or NULL
+	Item* findItem( co::int32 id );
+
+	// returns the item with the given id, adding an empty one if it is not cached
+	Item& getItem( co::int32 id );
+
+	// adds an empty item to the recent generation (which must not contain \a id)
+	Item& addItem( co::int32 id );
+
+	// removes the items with a position matching the given ranges (or an unknown position)
+	void removeMatching( co::int32 parentId, int firstRow, int lastRow, int firstColumn, int lastColumn );
+	static void removeMatching( ItemMap& map, co::int32 parentId, int firstRow, int lastRow, int firstColumn, int lastColumn );
+
+private:
+	int _capacity;
+	ItemMap _recent;
+	ItemMap _old;
+};
+
+#endif // _ITEMDATACACHE_H_
@@ -0,0 +1,57 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "LazyMimeData.h"
+#include "AbstractItemModel.h"
+#include <qt/MimeData.h>
+#include <co/Range.h>
+
+namespace qt {
+
+const char* const LazyMimeData::ITEM_INDEXES_MIME_TYPE = "application/x-coral-qt-item-indexes";
+
+LazyMimeData::LazyMimeData( AbstractItemModel* source, const QStringList& formats, std::vector<co::int32>& indexes )
+	: _source( source ), _formats( formats ), _serialized( false )
+{
+	_indexes.swap( indexes );
+	if( !_formats.contains( ITEM_INDEXES_MIME_TYPE ) )
+		_formats.push_back( ITEM_INDEXES_MIME_TYPE );
+}
+
+LazyMimeData::~LazyMimeData()
+{;}
+
+QStringList LazyMimeData::formats() const
+{
+	return _formats;
+}
+
+QVariant LazyMimeData::retrieveData( const QString& mimeType, QVariant::Type type ) const
+{
+	if( mimeType == ITEM_INDEXES_MIME_TYPE )
+	{
+		if( _indexes.empty() )
+			return QByteArray();
+		return QByteArray( reinterpret_cast<const char*>( &_indexes[0] ), static_cast<int>( _indexes.size() * sizeof(co::int32) ) );
+	}
+
+	// serialize all formats once, on the first request (the flag also guards against
+	// delegates that read the data back while serializing it)
+	if( !_serialized && _source )
+	{
+		_serialized = true;
+
+		qt::IAbstractItemModelDelegate* delegate = _source->getDelegate();
+		if( delegate )
+		{
+			qt::MimeData wrapper( const_cast<LazyMimeData*>( this ) );
+			delegate->mimeData( co::Range<const co::int32>( _indexes ), wrapper );
+		}
+	}
+
+	return QMimeData::retrieveData( mimeType, type );
+}
+
+} // namespace qt
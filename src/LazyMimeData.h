@@ -0,0 +1,58 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _LAZYMIMEDATA_H_
+#define _LAZYMIMEDATA_H_
+
+#include <co/Platform.h>
+#include <QMimeData>
+#include <QStringList>
+#include <QPointer>
+#include <vector>
+
+namespace qt {
+
+class AbstractItemModel;
+
+/*!
+	Mime data for the items dragged from an AbstractItemModel. The model's delegate
+	only serializes the items (through IAbstractItemModelDelegate::mimeData()) when
+	the data is actually retrieved, which a drop within the same process may avoid
+	altogether (see IAbstractItemModelDelegate::dropIndexes()).
+ */
+class LazyMimeData : public QMimeData
+{
+	Q_OBJECT
+
+public:
+	//! Format of the dragged item indexes, as a packed int32 array (see MimeData::getIndexes()).
+	static const char* const ITEM_INDEXES_MIME_TYPE;
+
+public:
+	LazyMimeData( AbstractItemModel* source, const QStringList& formats, std::vector<co::int32>& indexes );
+
+	virtual ~LazyMimeData();
+
+	//! The model the items were dragged from, or NULL if it was destroyed.
+	inline AbstractItemModel* getSource() const { return _source; }
+
+	//! The indexes of the dragged items in the source model.
+	inline const std::vector<co::int32>& getIndexes() const { return _indexes; }
+
+	QStringList formats() const;
+
+protected:
+	QVariant retrieveData( const QString& mimeType, QVariant::Type type ) const;
+
+private:
+	QPointer<AbstractItemModel> _source;
+	QStringList _formats;
+	std::vector<co::int32> _indexes;
+	mutable bool _serialized;
+};
+
+} // namespace qt
+
+#endif // _LAZYMIMEDATA_H_
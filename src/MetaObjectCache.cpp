@@ -0,0 +1,74 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "MetaObjectCache.h"
+#include "ValueConverters.h"
+#include <co/IllegalArgumentException.h>
+#include <QMetaMethod>
+#include <map>
+
+namespace {
+	typedef std::pair<const QMetaObject*, std::string> MemberKey;
+	typedef std::map<MemberKey, InvokePlan> PlanTable;
+	PlanTable s_invokePlans;
+
+	typedef std::map<MemberKey, int> PropertyTable;
+	PropertyTable s_propertyIndexes;
+}
+
+const InvokePlan& getInvokePlan( const QMetaObject* metaObject, const std::string& signature )
+{
+	MemberKey key( metaObject, signature );
+	PlanTable::iterator it = s_invokePlans.find( key );
+	if( it != s_invokePlans.end() )
+		return it->second;
+
+	int methodIdx = metaObject->indexOfMethod( signature.c_str() );
+	if( methodIdx < 0 )
+		CORAL_THROW( co::IllegalArgumentException, "no such method " << metaObject->className() << "::" << signature );
+
+	QList<QByteArray> paramTypes = metaObject->method( methodIdx ).parameterTypes();
+	if( paramTypes.size() > InvokePlan::MAX_ARGS )
+		CORAL_THROW( co::IllegalArgumentException, "method " << metaObject->className() << "::" << signature <<
+					 " exceeds the limit of " << InvokePlan::MAX_ARGS << " parameters" );
+
+	InvokePlan plan;
+	plan.metaObject = metaObject;
+	plan.methodIndex = methodIdx;
+	plan.argCount = paramTypes.size();
+	for( int i = 0; i < plan.argCount; ++i )
+		plan.argTypes[i] = QMetaType::type( paramTypes[i].constData() );
+
+	return s_invokePlans.insert( std::make_pair( key, plan ) ).first->second;
+}
+
+void convertInvokeArguments( const InvokePlan& plan, const co::Any* const* args,
+							 QVariant* vars, QGenericArgument* genericArgs )
+{
+	for( int i = 0; i < plan.argCount; ++i )
+	{
+		if( plan.argTypes[i] == 0 )
+		{
+			QMetaMethod mm = plan.metaObject->method( plan.methodIndex );
+			CORAL_THROW( co::IllegalArgumentException, "unsupported parameter type '" << mm.parameterTypes()[i].constData()
+						 << "' in " << plan.metaObject->className() << "::" << mm.signature() );
+		}
+
+		anyToVariant( *args[i], plan.argTypes[i], vars[i] );
+		variantToArgument( vars[i], genericArgs[i] );
+	}
+}
+
+int getPropertyIndex( const QMetaObject* metaObject, const std::string& name )
+{
+	MemberKey key( metaObject, name );
+	PropertyTable::iterator it = s_propertyIndexes.find( key );
+	if( it != s_propertyIndexes.end() )
+		return it->second;
+
+	int index = metaObject->indexOfProperty( name.c_str() );
+	s_propertyIndexes.insert( std::make_pair( key, index ) );
+	return index;
+}
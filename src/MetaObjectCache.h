@@ -0,0 +1,55 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _METAOBJECTCACHE_H_
+#define _METAOBJECTCACHE_H_
+
+#include <co/Any.h>
+#include <QMetaObject>
+#include <QVariant>
+#include <QGenericArgument>
+#include <string>
+
+/*!
+	A method call resolved against a QMetaObject: everything Object.invoke() needs
+	to know about the method, so repeated calls skip the metaobject lookups.
+ */
+struct InvokePlan
+{
+	static const int MAX_ARGS = 7;
+
+	const QMetaObject* metaObject;
+	int methodIndex;
+	int argCount;
+	int argTypes[MAX_ARGS]; // QMetaType ids of the parameters (0 if unregistered)
+};
+
+/*!
+	Returns the plan for invoking the method with the given (normalized) \a signature
+	on objects of class \a metaObject. Plans are resolved on first use and kept for
+	the lifetime of the application. Raises co::IllegalArgumentException if the
+	method does not exist or has too many parameters.
+	Must only be called from the GUI thread.
+ */
+const InvokePlan& getInvokePlan( const QMetaObject* metaObject, const std::string& signature );
+
+/*!
+	Converts the arguments \a args (which must have InvokePlan::MAX_ARGS elements) of a
+	call to the method of the given \a plan into \a vars, and sets \a genericArgs to
+	point into them, ready for QMetaMethod::invoke().
+	Raises co::IllegalArgumentException if an argument cannot be converted.
+ */
+void convertInvokeArguments( const InvokePlan& plan, const co::Any* const* args,
+							 QVariant* vars, QGenericArgument* genericArgs );
+
+/*!
+	Returns the index of the property called \a name in class \a metaObject, or -1
+	if the class has no such property (the object may still have a dynamic property
+	with that name). Like invoke plans, lookups are cached for the lifetime of the
+	application. Must only be called from the GUI thread.
+ */
+int getPropertyIndex( const QMetaObject* metaObject, const std::string& name );
+
+#endif // _METAOBJECTCACHE_H_
@@ -5,7 +5,9 @@
 #include <QColor>
 #include <qt/MimeData.h>
 #include <ValueConverters.h>
+#include <StringBridge.h>
 #include <iostream>
+#include <cstring>
 
 namespace qt
 {
@@ -19,7 +21,7 @@ void MimeData_Adapter::getData( qt::MimeData& instance, const std::string& mimeT
 	{
 		QString text;
 		stream >> text;
-		data.push_back( text.toLatin1().data() );
+		data.push_back( toUtf8String( text ) );
 	}
 }
 
@@ -29,10 +31,90 @@ void MimeData_Adapter::setData( qt::MimeData& instance, const std::string& mimeT
 	QDataStream stream( &encodedData, QIODevice::WriteOnly );
 	for( ; data; data.popFirst() )
 	{
-		stream << QString( data.getFirst().c_str() );
+		stream << toQString( data.getFirst() );
 	}   
 
 	instance.get()->setData( mimeType.c_str(), encodedData );
 }
 
+bool MimeData_Adapter::hasFormat( qt::MimeData& instance, const std::string& mimeType )
+{
+	return instance.get()->hasFormat( mimeType.c_str() );
+}
+
+void MimeData_Adapter::getBytes( qt::MimeData& instance, const std::string& mimeType, std::string& bytes )
+{
+	QByteArray encodedData = instance.get()->data( mimeType.c_str() );
+	bytes.assign( encodedData.constData(), encodedData.size() );
+}
+
+void MimeData_Adapter::setBytes( qt::MimeData& instance, const std::string& mimeType, const std::string& bytes )
+{
+	instance.get()->setData( mimeType.c_str(), QByteArray( bytes.data(), static_cast<int>( bytes.size() ) ) );
+}
+
+void MimeData_Adapter::getIndexes( qt::MimeData& instance, const std::string& mimeType, std::vector<co::int32>& indexes )
+{
+	QByteArray encodedData = instance.get()->data( mimeType.c_str() );
+	size_t count = encodedData.size() / sizeof(co::int32);
+	indexes.resize( count );
+	if( count > 0 )
+		std::memcpy( &indexes[0], encodedData.constData(), count * sizeof(co::int32) );
+}
+
+void MimeData_Adapter::setIndexes( qt::MimeData& instance, const std::string& mimeType, co::Range<co::int32 const> indexes )
+{
+	QByteArray encodedData;
+	encodedData.resize( static_cast<int>( indexes.getSize() * sizeof(co::int32) ) );
+	if( !indexes.isEmpty() )
+		std::memcpy( encodedData.data(), &indexes.getFirst(), encodedData.size() );
+
+	instance.get()->setData( mimeType.c_str(), encodedData );
+}
+
+void MimeData_Adapter::getRecords( qt::MimeData& instance, const std::string& mimeType, std::vector<std::string>& records )
+{
+	records.clear();
+
+	QByteArray encodedData = instance.get()->data( mimeType.c_str() );
+	const char* data = encodedData.constData();
+	const char* end = data + encodedData.size();
+
+	while( end - data >= static_cast<ptrdiff_t>( sizeof(quint32) ) )
+	{
+		quint32 length;
+		std::memcpy( &length, data, sizeof(quint32) );
+		data += sizeof(quint32);
+
+		// stop at truncated (or foreign) payloads
+		if( static_cast<size_t>( end - data ) < length )
+			break;
+
+		records.push_back( std::string( data, length ) );
+		data += length;
+	}
+}
+
+void MimeData_Adapter::setRecords( qt::MimeData& instance, const std::string& mimeType, co::Range<std::string const> records )
+{
+	int size = 0;
+	for( co::Range<std::string const> r( records ); r; r.popFirst() )
+		size += static_cast<int>( sizeof(quint32) + r.getFirst().size() );
+
+	QByteArray encodedData;
+	encodedData.resize( size );
+	char* data = encodedData.data();
+	for( ; records; records.popFirst() )
+	{
+		const std::string& record = records.getFirst();
+		quint32 length = static_cast<quint32>( record.size() );
+		std::memcpy( data, &length, sizeof(quint32) );
+		data += sizeof(quint32);
+		std::memcpy( data, record.data(), length );
+		data += length;
+	}
+
+	instance.get()->setData( mimeType.c_str(), encodedData );
+}
+
 } // namespace qt
@@ -5,6 +5,10 @@
 
 #include "Object_Adapter.h"
 #include "ValueConverters.h"
+#include "StringBridge.h"
+#include "MetaObjectCache.h"
+#include "ChildNameIndex.h"
+#include "UpdatesGuard.h"
 #include <co/IllegalArgumentException.h>
 #include <qt/Object.h>
 #include <qt/Variant.h>
@@ -19,17 +23,56 @@ co::int64 qt::Object_Adapter::getHash( qt::Object& instance )
 	return reinterpret_cast<co::int64>( instance.get() );
 }
 
+namespace {
+
+// reads a static or dynamic property into 'value'; returns false if there is no such property
+bool readProperty( QObject* obj, const std::string& name, co::Any& value )
+{
+	const QMetaObject* metaObj = obj->metaObject();
+
+	QVariant v;
+	int propertyIdx = getPropertyIndex( metaObj, name );
+	if( propertyIdx >= 0 )
+		v = metaObj->property( propertyIdx ).read( obj );
+	else if( !obj->dynamicPropertyNames().isEmpty() )
+		v = obj->property( internName( name ).bytes.constData() );
+
+	if( !v.isValid() )
+		return false;
+
+	variantToAny( v, value );
+	return true;
+}
+
+void writeProperty( QObject* obj, const std::string& name, const co::Any& value )
+{
+	const QMetaObject* metaObj = obj->metaObject();
+	int propertyIdx = getPropertyIndex( metaObj, name );
+	QMetaProperty property = metaObj->property( propertyIdx );
+
+	// dynamic properties take any Qt type
+	QVariant v;
+	anyToVariant( value, propertyIdx >= 0 ? static_cast<int>( property.type() ) : static_cast<int>( QMetaType::QVariant ), v );
+	if( propertyIdx >= 0 )
+		property.write( obj, v );
+	else
+		obj->setProperty( internName( name ).bytes.constData(), v );
+
+	// Qt sends no event when objects are renamed
+	if( name == "objectName" )
+		ChildNameIndex::instance().invalidate( obj );
+}
+
+} // anonymous namespace
+
 void qt::Object_Adapter::getPropertyOrChild( qt::Object& instance, const std::string& name, co::Any& value )
 {
-	assert( instance.get() );
-	QVariant v = instance.get()->property( name.c_str() );
-	if( v.isValid() )
-	{
-		variantToAny( v, value );
+	QObject* obj = instance.get();
+	assert( obj );
+	if( readProperty( obj, name, value ) )
 		return;
-	}
 
-	QObject* child = instance.get()->findChild<QObject*>( name.c_str() );
+	QObject* child = ChildNameIndex::instance().findChild( obj, internName( name ).string );
 	if( child )
 		value.createComplexValue<qt::Object>().set( child );
 }
@@ -37,12 +80,35 @@ void qt::Object_Adapter::getPropertyOrChild( qt::Object& instance, const std::st
 void qt::Object_Adapter::setProperty( qt::Object& instance, const std::string& name, const co::Any& value )
 {
 	assert( instance.get() );
-	const QMetaObject* metaObj = instance.get()->metaObject();
-	QMetaProperty property = metaObj->property( metaObj->indexOfProperty( name.c_str() ) );
+	writeProperty( instance.get(), name, value );
+}
 
-	QVariant v;
-	anyToVariant( value, property.type(), v );
-	instance.get()->setProperty( name.c_str(), v );
+void qt::Object_Adapter::getProperties( qt::Object& instance, co::Range<std::string const> names,
+										std::vector<co::Any>& values )
+{
+	QObject* obj = instance.get();
+	assert( obj );
+	values.resize( names.getSize() );
+	for( size_t i = 0; names; names.popFirst(), ++i )
+		readProperty( obj, names.getFirst(), values[i] );
+}
+
+void qt::Object_Adapter::setProperties( qt::Object& instance, co::Range<std::string const> names,
+										co::Range<co::Any const> values )
+{
+	QObject* obj = instance.get();
+	assert( obj );
+	if( names.getSize() != values.getSize() )
+		CORAL_THROW( co::IllegalArgumentException, "got " << names.getSize() << " property names but "
+					 << values.getSize() << " values" );
+
+	// a single change repaints the object once anyway
+	UpdatesGuard guard;
+	if( names.getSize() > 1 )
+		guard.add( obj );
+
+	for( ; names; names.popFirst(), values.popFirst() )
+		writeProperty( obj, names.getFirst(), values.getFirst() );
 }
 
 void qt::Object_Adapter::invoke( qt::Object& instance, const std::string& methodSignature, const co::Any& p1,
@@ -51,28 +117,14 @@ void qt::Object_Adapter::invoke( qt::Object& instance, const std::string& method
 {
 	QObject* obj = instance.get();
 	const QMetaObject* metaObj = obj->metaObject();
-	int methodIdx = metaObj->indexOfMethod( methodSignature.c_str() );
-	if( methodIdx < 0 )
-		CORAL_THROW( co::IllegalArgumentException, "no such method " << metaObj->className() << "::" << methodSignature );		
-
-	QMetaMethod mm = metaObj->method( methodIdx );
-	QList<QByteArray> paramTypes = mm.parameterTypes();
-
-	const int MAX_NUM_ARGS = 7;
-	int numArgs = paramTypes.size();
-	if( numArgs > MAX_NUM_ARGS )
-		CORAL_THROW( co::IllegalArgumentException, "method " << metaObj->className() << "::" << methodSignature <<
-					 "exceeds the limit of " << MAX_NUM_ARGS << " parameters" );
+	const InvokePlan& plan = getInvokePlan( metaObj, methodSignature );
+	QMetaMethod mm = metaObj->method( plan.methodIndex );
 
 	// prepare arguments
 	const co::Any* any[] = { &p1, &p2, &p3, &p4, &p5, &p6, &p7 };
-	QVariant var[MAX_NUM_ARGS];
-	QGenericArgument arg[MAX_NUM_ARGS];
-	for( int i = 0; i < numArgs; ++i )
-	{
-		anyToVariant( *any[i], paramTypes[i].constData(), var[i] );
-		variantToArgument( var[i], arg[i] );
-	}
+	QVariant var[InvokePlan::MAX_ARGS];
+	QGenericArgument arg[InvokePlan::MAX_ARGS];
+	convertInvokeArguments( plan, any, var, arg );
 
 	bool ok = mm.invoke( obj, arg[0], arg[1], arg[2], arg[3], arg[4], arg[5], arg[6] );
 	if( !ok ) 
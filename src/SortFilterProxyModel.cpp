@@ -0,0 +1,282 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "SortFilterProxyModel.h"
+#include "StringBridge.h"
+#include <qt/Object.h>
+#include <co/IllegalArgumentException.h>
+#include <QAbstractItemView>
+
+namespace qt {
+
+SortFilterProxyModel::SortFilterProxyModel() : _filterColumn( 0 ), _filterCaseSensitive( false ), _sortCaseSensitive( true )
+{
+	QSortFilterProxyModel::setFilterRole( Qt::DisplayRole );
+	QSortFilterProxyModel::setSortRole( Qt::DisplayRole );
+}
+
+SortFilterProxyModel::~SortFilterProxyModel()
+{;}
+
+qt::IAbstractItemModel* SortFilterProxyModel::getSource()
+{
+	return _source.get();
+}
+
+void SortFilterProxyModel::setSource( qt::IAbstractItemModel* source )
+{
+	QAbstractItemModel* model = 0;
+	if( source )
+	{
+		model = dynamic_cast<QAbstractItemModel*>( source );
+		if( !model )
+			CORAL_THROW( co::IllegalArgumentException, "the source model is not a QAbstractItemModel" );
+	}
+
+	QAbstractItemModel* previous = sourceModel();
+	if( previous )
+		QObject::disconnect( previous, 0, this, 0 );
+
+	_source = source;
+	clearFilterKeys();
+	clearSortKeys();
+
+	// our slots must run before those QSortFilterProxyModel connects in setSourceModel()
+	if( model )
+	{
+		connect( model, SIGNAL( dataChanged( const QModelIndex&, const QModelIndex& ) ),
+				 this, SLOT( sourceDataChanged( const QModelIndex&, const QModelIndex& ) ) );
+		connect( model, SIGNAL( rowsInserted( const QModelIndex&, int, int ) ), this, SLOT( sourceStructureChanged() ) );
+		connect( model, SIGNAL( rowsRemoved( const QModelIndex&, int, int ) ), this, SLOT( sourceStructureChanged() ) );
+		connect( model, SIGNAL( columnsInserted( const QModelIndex&, int, int ) ), this, SLOT( sourceStructureChanged() ) );
+		connect( model, SIGNAL( columnsRemoved( const QModelIndex&, int, int ) ), this, SLOT( sourceStructureChanged() ) );
+		connect( model, SIGNAL( layoutChanged() ), this, SLOT( sourceStructureChanged() ) );
+		connect( model, SIGNAL( modelReset() ), this, SLOT( sourceStructureChanged() ) );
+	}
+
+	QSortFilterProxyModel::setSourceModel( model );
+}
+
+std::string SortFilterProxyModel::getFilterText()
+{
+	return _filterTextValue;
+}
+
+void SortFilterProxyModel::setFilterText( const std::string& filterText )
+{
+	QString text = toQString( filterText );
+	if( !_filterCaseSensitive )
+		text = text.toCaseFolded();
+
+	// rows without the old text cannot contain a text that extends it
+	if( !text.contains( _filterText ) )
+		_rejectedRows.clear();
+
+	_filterTextValue = filterText;
+	_filterText = text;
+	invalidateFilter();
+}
+
+co::int32 SortFilterProxyModel::getFilterColumn()
+{
+	return _filterColumn;
+}
+
+void SortFilterProxyModel::setFilterColumn( co::int32 filterColumn )
+{
+	if( filterColumn < -1 )
+		CORAL_THROW( co::IllegalArgumentException, "illegal filter column (" << filterColumn << ")" );
+
+	_filterColumn = filterColumn;
+	_rejectedRows.clear();
+	invalidateFilter();
+}
+
+co::int32 SortFilterProxyModel::getFilterRole()
+{
+	return filterRole();
+}
+
+void SortFilterProxyModel::setFilterRole( co::int32 role )
+{
+	QSortFilterProxyModel::setFilterRole( role );
+	clearFilterKeys();
+	invalidateFilter();
+}
+
+bool SortFilterProxyModel::getFilterCaseSensitive()
+{
+	return _filterCaseSensitive;
+}
+
+void SortFilterProxyModel::setFilterCaseSensitive( bool filterCaseSensitive )
+{
+	if( filterCaseSensitive == _filterCaseSensitive )
+		return;
+
+	_filterCaseSensitive = filterCaseSensitive;
+	_filterText = _filterCaseSensitive ? toQString( _filterTextValue ) : _filterText.toCaseFolded();
+	clearFilterKeys();
+	invalidateFilter();
+}
+
+co::int32 SortFilterProxyModel::getSortRole()
+{
+	return sortRole();
+}
+
+void SortFilterProxyModel::setSortRole( co::int32 role )
+{
+	clearSortKeys();
+	QSortFilterProxyModel::setSortRole( role );
+}
+
+bool SortFilterProxyModel::getSortCaseSensitive()
+{
+	return _sortCaseSensitive;
+}
+
+void SortFilterProxyModel::setSortCaseSensitive( bool sortCaseSensitive )
+{
+	if( sortCaseSensitive == _sortCaseSensitive )
+		return;
+
+	_sortCaseSensitive = sortCaseSensitive;
+	clearSortKeys();
+	invalidate();
+}
+
+void SortFilterProxyModel::sort( co::int32 column, co::int32 order )
+{
+	QSortFilterProxyModel::sort( column, order == Qt::DescendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder );
+}
+
+void SortFilterProxyModel::installModel( const qt::Object& view )
+{
+	QAbstractItemView* qtView = qobject_cast<QAbstractItemView*>( view.get() );
+	if( !qtView )
+		CORAL_THROW( co::IllegalArgumentException, "cannot install the proxy model: the object is not a QAbstractItemView" );
+
+	if( !_source.get() )
+		CORAL_THROW( co::IllegalArgumentException, "cannot install the proxy model: its source model is not set" );
+
+	// the source model keeps this proxy as the view's model (see AbstractItemModel::installModel())
+	qtView->setModel( this );
+	_source->installModel( view );
+}
+
+bool SortFilterProxyModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const
+{
+	if( _filterText.isEmpty() )
+		return true;
+
+	QAbstractItemModel* model = sourceModel();
+	quint64 row = itemKey( model->index( sourceRow, 0, sourceParent ) );
+	if( _rejectedRows.contains( row ) )
+		return false;
+
+	int firstColumn = _filterColumn;
+	int lastColumn = _filterColumn;
+	if( _filterColumn < 0 )
+	{
+		firstColumn = 0;
+		lastColumn = model->columnCount( sourceParent ) - 1;
+	}
+
+	for( int column = firstColumn; column <= lastColumn; ++column )
+	{
+		// keys are already folded: a case-sensitive search is enough (and faster)
+		if( filterKey( model->index( sourceRow, column, sourceParent ) ).contains( _filterText, Qt::CaseSensitive ) )
+			return true;
+	}
+
+	_rejectedRows.insert( row );
+	return false;
+}
+
+bool SortFilterProxyModel::lessThan( const QModelIndex& left, const QModelIndex& right ) const
+{
+	const QVariant& l = sortKey( left );
+	const QVariant& r = sortKey( right );
+
+	if( l.type() != QVariant::String && r.type() != QVariant::String )
+	{
+		bool leftIsNumber, rightIsNumber;
+		double leftNumber = l.toDouble( &leftIsNumber );
+		double rightNumber = r.toDouble( &rightIsNumber );
+		if( leftIsNumber && rightIsNumber )
+			return leftNumber < rightNumber;
+	}
+
+	return l.toString() < r.toString();
+}
+
+void SortFilterProxyModel::sourceDataChanged( const QModelIndex& topLeft, const QModelIndex& bottomRight )
+{
+	if( !topLeft.isValid() || !bottomRight.isValid() )
+		return;
+
+	QAbstractItemModel* model = sourceModel();
+	QModelIndex parent = topLeft.parent();
+	for( int row = topLeft.row(); row <= bottomRight.row(); ++row )
+	{
+		_rejectedRows.remove( itemKey( model->index( row, 0, parent ) ) );
+		for( int column = topLeft.column(); column <= bottomRight.column(); ++column )
+		{
+			quint64 key = itemKey( model->index( row, column, parent ) );
+			_filterKeys.remove( key );
+			_sortKeys.remove( key );
+		}
+	}
+}
+
+void SortFilterProxyModel::sourceStructureChanged()
+{
+	clearFilterKeys();
+	clearSortKeys();
+}
+
+const QString& SortFilterProxyModel::filterKey( const QModelIndex& sourceIndex ) const
+{
+	quint64 key = itemKey( sourceIndex );
+	QHash<quint64, QString>::iterator it = _filterKeys.find( key );
+	if( it == _filterKeys.end() )
+	{
+		QString text = sourceModel()->data( sourceIndex, filterRole() ).toString();
+		if( !_filterCaseSensitive )
+			text = text.toCaseFolded();
+		it = _filterKeys.insert( key, text );
+	}
+	return *it;
+}
+
+const QVariant& SortFilterProxyModel::sortKey( const QModelIndex& sourceIndex ) const
+{
+	quint64 key = itemKey( sourceIndex );
+	QHash<quint64, QVariant>::iterator it = _sortKeys.find( key );
+	if( it == _sortKeys.end() )
+	{
+		QVariant value = sourceModel()->data( sourceIndex, sortRole() );
+		if( !_sortCaseSensitive && value.type() == QVariant::String )
+			value = value.toString().toCaseFolded();
+		it = _sortKeys.insert( key, value );
+	}
+	return *it;
+}
+
+void SortFilterProxyModel::clearFilterKeys()
+{
+	_filterKeys.clear();
+	_rejectedRows.clear();
+}
+
+void SortFilterProxyModel::clearSortKeys()
+{
+	_sortKeys.clear();
+}
+
+CORAL_EXPORT_COMPONENT( SortFilterProxyModel, SortFilterProxyModel )
+
+} // namespace qt
@@ -0,0 +1,98 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _SORTFILTERPROXYMODEL_H_
+#define _SORTFILTERPROXYMODEL_H_
+
+#include "SortFilterProxyModel_Base.h"
+#include <qt/IAbstractItemModel.h>
+#include <co/RefPtr.h>
+#include <QSortFilterProxyModel>
+#include <QHash>
+#include <QSet>
+
+namespace qt {
+
+class SortFilterProxyModel : public QSortFilterProxyModel, public SortFilterProxyModel_Base
+{
+	Q_OBJECT
+
+public:
+	SortFilterProxyModel();
+
+	virtual ~SortFilterProxyModel();
+
+	// qt.ISortFilterProxyModel methods:
+	qt::IAbstractItemModel* getSource();
+	void setSource( qt::IAbstractItemModel* source );
+
+	std::string getFilterText();
+	void setFilterText( const std::string& filterText );
+
+	co::int32 getFilterColumn();
+	void setFilterColumn( co::int32 filterColumn );
+
+	co::int32 getFilterRole();
+	void setFilterRole( co::int32 filterRole );
+
+	bool getFilterCaseSensitive();
+	void setFilterCaseSensitive( bool filterCaseSensitive );
+
+	co::int32 getSortRole();
+	void setSortRole( co::int32 sortRole );
+
+	bool getSortCaseSensitive();
+	void setSortCaseSensitive( bool sortCaseSensitive );
+
+	void sort( co::int32 column, co::int32 order );
+
+	void installModel( const qt::Object& view );
+
+protected:
+	// QSortFilterProxyModel methods:
+	bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const;
+	bool lessThan( const QModelIndex& left, const QModelIndex& right ) const;
+
+private slots:
+	// keys of the changed items are removed before the proxy itself is updated
+	void sourceDataChanged( const QModelIndex& topLeft, const QModelIndex& bottomRight );
+
+	// item ids may be reassigned after structural changes, so all keys are removed
+	void sourceStructureChanged();
+
+private:
+	// identifies an item by its id in the source model and its column
+	static inline quint64 itemKey( const QModelIndex& sourceIndex )
+	{
+		return ( static_cast<quint64>( static_cast<quint32>( sourceIndex.internalId() ) ) << 32 )
+			| static_cast<quint32>( sourceIndex.column() );
+	}
+
+	const QString& filterKey( const QModelIndex& sourceIndex ) const;
+	const QVariant& sortKey( const QModelIndex& sourceIndex ) const;
+
+	void clearFilterKeys();
+	void clearSortKeys();
+
+private:
+	co::RefPtr<qt::IAbstractItemModel> _source;
+
+	std::string _filterTextValue; // as set by the user
+	QString _filterText; // case-folded unless filtering is case-sensitive
+	int _filterColumn;
+	bool _filterCaseSensitive;
+	bool _sortCaseSensitive;
+
+	mutable QHash<quint64, QString> _filterKeys;
+	mutable QHash<quint64, QVariant> _sortKeys;
+
+	// rows (identified by their first column) rejected by the current filter text,
+	// which remain rejected while the text is only extended
+	mutable QSet<quint64> _rejectedRows;
+};
+
+} // namespace qt
+
+#endif // _SORTFILTERPROXYMODEL_H_
@@ -0,0 +1,75 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "StringBridge.h"
+#include <map>
+
+namespace {
+	// bounds the memory taken by interned names
+	const size_t MAX_INTERNED_NAMES = 4096;
+
+	typedef std::map<std::string, InternedName> NameTable;
+	NameTable s_names;
+}
+
+void assignUtf8( std::string& str, const QString& qstr )
+{
+	const int length = qstr.size();
+	const ushort* utf16 = qstr.utf16();
+
+	// a UTF-16 code unit takes at most 3 bytes in UTF-8 (surrogate pairs take 4 for 2 units)
+	str.resize( length * 3 );
+	char* out = length > 0 ? &str[0] : 0;
+	char* begin = out;
+
+	for( int i = 0; i < length; ++i )
+	{
+		uint c = utf16[i];
+		if( c < 0x80 )
+		{
+			*out++ = static_cast<char>( c );
+			continue;
+		}
+
+		if( c < 0x800 )
+		{
+			*out++ = static_cast<char>( 0xC0 | ( c >> 6 ) );
+			*out++ = static_cast<char>( 0x80 | ( c & 0x3F ) );
+			continue;
+		}
+
+		if( QChar::isHighSurrogate( c ) && i + 1 < length && QChar::isLowSurrogate( utf16[i + 1] ) )
+		{
+			c = QChar::surrogateToUcs4( static_cast<ushort>( c ), utf16[++i] );
+			*out++ = static_cast<char>( 0xF0 | ( c >> 18 ) );
+			*out++ = static_cast<char>( 0x80 | ( ( c >> 12 ) & 0x3F ) );
+		}
+		else
+		{
+			// lone surrogates are encoded as is (like QString::toUtf8() does)
+			*out++ = static_cast<char>( 0xE0 | ( c >> 12 ) );
+		}
+		*out++ = static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+		*out++ = static_cast<char>( 0x80 | ( c & 0x3F ) );
+	}
+
+	str.resize( out - begin );
+}
+
+InternedName internName( const std::string& name )
+{
+	NameTable::iterator it = s_names.find( name );
+	if( it != s_names.end() )
+		return it->second;
+
+	InternedName interned;
+	interned.bytes = QByteArray( name.data(), static_cast<int>( name.size() ) );
+	interned.string = toQString( name );
+
+	if( s_names.size() < MAX_INTERNED_NAMES )
+		s_names.insert( std::make_pair( name, interned ) );
+
+	return interned;
+}
@@ -0,0 +1,54 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _STRINGBRIDGE_H_
+#define _STRINGBRIDGE_H_
+
+#include <QString>
+#include <QByteArray>
+#include <string>
+
+/*
+	Conversions between Coral strings (std::string, always UTF-8 encoded) and
+	QStrings. They decode or encode in a single pass, without going through a
+	temporary QByteArray or C string.
+ */
+
+//! Decodes a UTF-8 std::string into a QString.
+inline QString toQString( const std::string& str )
+{
+	return QString::fromUtf8( str.data(), static_cast<int>( str.size() ) );
+}
+
+//! Encodes a QString as UTF-8, directly into \a str (replacing its contents).
+void assignUtf8( std::string& str, const QString& qstr );
+
+//! Returns the UTF-8 encoding of a QString.
+inline std::string toUtf8String( const QString& qstr )
+{
+	std::string str;
+	assignUtf8( str, qstr );
+	return str;
+}
+
+/*!
+	A property, signal, method or object name in the forms Qt expects, shared by all
+	lookups of the same name (see internName()).
+ */
+struct InternedName
+{
+	QByteArray bytes;	// for QObject::property(), QMetaObject::indexOf*(), etc.
+	QString string;		// for QObject::findChild(), objectName comparisons, etc.
+};
+
+/*!
+	Returns the interned forms of a name, creating them on first use. Meant for the
+	(few, recurring) names used to access objects from scripts; past a fixed number
+	of names, new names are converted on every call instead. Not thread-safe: must
+	only be called from the GUI thread.
+ */
+InternedName internName( const std::string& name );
+
+#endif // _STRINGBRIDGE_H_
@@ -5,19 +5,28 @@
 
 #include "Timer.h"
 #include "EventHub.h"
+#include "EventRouter.h"
 #include "System_Base.h"
 #include "ConnectionHub.h"
 #include "AbstractItemModel.h"
 #include "ValueConverters.h"
+#include "StringBridge.h"
+#include "UpdatesGuard.h"
+#include "ChildNameIndex.h"
+#include "MetaObjectCache.h"
 
 #include <co/NotSupportedException.h>
 #include <co/IllegalArgumentException.h>
 
 #include <qt/Exception.h>
 #include <qt/ITimerCallback.h>
+#include <qt/IBatchConnectionHandler.h>
+#include <qt/ConnectionStats.h>
 #include <qt/IAbstractItemModel.h>
 #include <qt/IAbstractItemModelDelegate.h>
+#include <qt/IValueConverter.h>
 
+#include <QAbstractProxyModel>
 #include <QAbstractItemView>
 #include <QAbstractItemModel>
 #include <QStringListModel>
@@ -32,11 +41,14 @@
 #include <QStatusBar>
 #include <QBoxLayout>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QBuffer>
 #include <QSplitter>
 #include <QUiLoader>
 #include <QComboBox>
 #include <QToolBar>
 #include <QAction>
+#include <QMetaMethod>
 #include <QLayout>
 #include <QCursor>
 #include <QLayout>
@@ -44,7 +56,9 @@
 #include <QFile>
 #include <QMenu>
 
+#include <algorithm>
 #include <sstream>
+#include <list>
 
 namespace {
 	int dummy_argc = 1;
@@ -83,13 +97,15 @@ class System : public qt::System_Base
 {
 public:
 	System() // must force _app initialization before _eventHub since _eventHub uses Qt qApp in constructor
-		: _app( new QApplication( dummy_argc, const_cast<char**>( dummy_argv ) ) ), _eventHub()
+		: _app( new QApplication( dummy_argc, const_cast<char**>( dummy_argv ) ) ), _eventHub(), _uiLoader( 0 )
 	{
 		_appObj.set( _app );
 	}
 
 	virtual ~System()
 	{
+		clearServiceConverters();
+		delete _uiLoader;
 		delete _app;
 	}
 
@@ -101,24 +117,18 @@ public:
 		if( parent.get() )
 			parentWidget = tryCastObject<QWidget>( parent, "cannot set parent widget" );
 
-		QUiLoader loader;
-
-		QFile uiFile( filePath.c_str() );
-		if( !uiFile.exists() )
+		QFileInfo fi( toQString( filePath ) );
+		if( !fi.exists() )
 			CORAL_THROW( qt::Exception, "could not open '" << filePath << "'" );
 
-		// change app work directory to ui's base directory
-		// so the ui loader can find relative icon paths
-		QString savedWorkDir = QDir::currentPath();
-
-		QFileInfo fi( filePath.c_str() );
-		QDir::setCurrent( fi.absolutePath() );
+		QBuffer buffer( &getUiContents( fi, filePath ) );
+		buffer.open( QIODevice::ReadOnly );
 
-		QWidget* resWidget = loader.load( &uiFile, NULL );
-
-		// restore workdir
-		QDir::setCurrent( savedWorkDir );
+		// relative icon paths are resolved against the ui's base directory
+		QUiLoader& loader = getUiLoader();
+		loader.setWorkingDirectory( fi.absoluteDir() );
 
+		QWidget* resWidget = loader.load( &buffer, NULL );
 		if( !resWidget )
 		{
 			CORAL_THROW( qt::Exception, "error loading ui file '" << filePath << "'"  );
@@ -133,40 +143,39 @@ public:
 		QStringList qtSearchPaths;
 		while( searchPaths )
 		{
-			std::string path = searchPaths.getFirst();
-			qtSearchPaths.push_back( path.c_str() );
+			qtSearchPaths.push_back( toQString( searchPaths.getFirst() ) );
 			searchPaths.popFirst();
 		}
 
-		QDir::setSearchPaths( prefix.c_str(), qtSearchPaths );
+		QDir::setSearchPaths( toQString( prefix ), qtSearchPaths );
 	}
 
 	void getExistingDirectory( const qt::Object& parent, const std::string& caption, const std::string& initialDir,
 							   std::string& selectedDir )
 	{
 		QString dir = QFileDialog::getExistingDirectory( qobject_cast<QWidget*>( parent.get() ),
-														 QString::fromStdString( caption ),
-														 QString::fromStdString( initialDir ) );
-		selectedDir = dir.toStdString();
+														 toQString( caption ),
+														 toQString( initialDir ) );
+		assignUtf8( selectedDir, dir );
 	}
 
 	void getOpenFileName( const qt::Object& parent, const std::string& caption, const std::string& initialDir,
 												const std::string& filter, std::string& selectedFile )
 	{
 		QString file = QFileDialog::getOpenFileName( qobject_cast<QWidget*>( parent.get() ),
-																											caption.c_str(), initialDir.c_str(), filter.c_str() );
+																											toQString( caption ), toQString( initialDir ), toQString( filter ) );
 
-		selectedFile = file.toStdString();
+		assignUtf8( selectedFile, file );
 	}
 
 	void getOpenFileNames( const qt::Object& parent, const std::string& caption, const std::string& initialDir,
 						   const std::string& filter, std::vector<std::string>& selectedFiles )
 	{
 		QStringList files = QFileDialog::getOpenFileNames( qobject_cast<QWidget*>( parent.get() ),
-														 caption.c_str(), initialDir.c_str(), filter.c_str() );
+														 toQString( caption ), toQString( initialDir ), toQString( filter ) );
 		for( int i = 0; i < files.size(); ++i )
 		{
-			selectedFiles.push_back( files[i].toStdString() );
+			selectedFiles.push_back( toUtf8String( files[i] ) );
 		}
 	}
 
@@ -174,23 +183,23 @@ public:
 						   const std::string& filter, std::string& selectedFile )
 	{
 		QString file = QFileDialog::getSaveFileName( qobject_cast<QWidget*>( parent.get() ),
-														 caption.c_str(), initialDir.c_str(), filter.c_str() );
-		selectedFile = file.toStdString();
+														 toQString( caption ), toQString( initialDir ), toQString( filter ) );
+		assignUtf8( selectedFile, file );
 	}
 
 	bool getInputText ( const qt::Object& parent, const std::string& dialogTitle, const std::string& label, const std::string& text, std::string& result )
 	{
 		bool ok = false;
 		QString ret = QInputDialog::getText( qobject_cast<QWidget*>( parent.get() ), QObject::tr( label.c_str() ),
-											  QObject::tr( label.c_str() ), QLineEdit::Normal, text.c_str(), &ok );
+											  QObject::tr( label.c_str() ), QLineEdit::Normal, toQString( text ), &ok );
 
-		result = ret.toStdString();
+		assignUtf8( result, ret );
 		return ok;
 	}
 
 	void newInstanceOf( const std::string& className, const qt::Object& parent, qt::Object& object )
 	{
-		QUiLoader loader;
+		QUiLoader& loader = getUiLoader();
 		QString name = className.c_str();
 		QWidget* parentWidget = qobject_cast<QWidget*>( parent.get() );
 		// check whether the className is a supported widget
@@ -413,9 +422,9 @@ public:
 		anyToVariant( userData, QMetaType::QVariant, v );
 
 		if( index == -1 )
-			qcomboBox->addItem( text.c_str(), v );
+			qcomboBox->addItem( toQString( text ), v );
 		else
-			qcomboBox->insertItem( index, text.c_str(), v );
+			qcomboBox->insertItem( index, toQString( text ), v );
 	}
 
 	void showPopup( const qt::Object& comboBox )
@@ -484,14 +493,173 @@ public:
 	void getModelFromView( const qt::Object& view, qt::IAbstractItemModel*& model  )
 	{
 		QAbstractItemView* qtView = tryCastObject<QAbstractItemView>( view, "cannot retrieve model from view" );
-		qt::IAbstractItemModel* ptr = dynamic_cast<qt::IAbstractItemModel*>( qtView->model() );
+
+		// unwrap proxy models (e.g. SortFilterProxyModel) set between the model and the view
+		QAbstractItemModel* viewModel = qtView->model();
+		while( QAbstractProxyModel* proxy = qobject_cast<QAbstractProxyModel*>( viewModel ) )
+			viewModel = proxy->sourceModel();
+
+		qt::IAbstractItemModel* ptr = dynamic_cast<qt::IAbstractItemModel*>( viewModel );
 		assert( ptr );
 		model = ptr;
 	}
 
-	co::int64 installEventHandler( const qt::Object& watched, qt::IEventHandler* handler )
+	co::int64 installEventHandler( const qt::Object& watched, qt::IEventHandler* handler,
+								   co::Range<co::int32 const> eventTypes, co::int32 priority )
+	{
+		return _eventHub.installEventHandler( watched, handler, eventTypes, priority );
+	}
+
+	void removeEventHandler( const qt::Object& watched, qt::IEventHandler* handler )
+	{
+		_eventHub.removeEventHandler( watched, handler );
+	}
+
+	co::int64 installEventRecordHandler( const qt::Object& watched, qt::IEventRecordHandler* handler,
+										 co::Range<co::int32 const> eventTypes, co::int32 priority )
+	{
+		return _eventHub.installEventRecordHandler( watched, handler, eventTypes, priority );
+	}
+
+	bool sendEvent( const qt::Object& receiver, const qt::EventRecord& record )
+	{
+		if( !receiver.get() )
+			throw co::IllegalArgumentException( "illegal null receiver" );
+
+		QEvent* event = EventHub::createEvent( record );
+		if( !event )
+			CORAL_THROW( co::IllegalArgumentException, "cannot send events of type " << record.type );
+
+		QCoreApplication::sendEvent( receiver.get(), event );
+		bool accepted = event->isAccepted();
+		delete event;
+		return accepted;
+	}
+
+	void getKeyName( co::int32 key, std::string& name )
+	{
+		name = EventHub::getKeyName( key );
+	}
+
+	void registerValueConverter( const std::string& typeName, qt::IValueConverter* converter )
+	{
+		int typeId = QMetaType::type( typeName.c_str() );
+		if( typeId == QMetaType::Void )
+			CORAL_THROW( co::IllegalArgumentException, "unknown Qt type '" << typeName << "'" );
+
+		registerValueConverters( typeId, converter );
+	}
+
+	void applyProperty( co::Range<qt::Object const> objects, const std::string& name, const co::Any& value )
+	{
+		// resolve the property and convert the value (once per class and type) before
+		// writing, so a null object or a failed conversion leaves all objects unchanged
+		size_t count = objects.getSize();
+		std::vector<QObject*> objs( count );
+		std::vector<QMetaProperty> properties( count ); // invalid for dynamic properties
+		std::vector<size_t> valueIndexes( count );
+		std::vector<int> types;
+		std::vector<QVariant> values;
+
+		const QMetaObject* lastMetaObj = 0;
+		QMetaProperty property;
+		size_t valueIdx = 0;
+
+		for( size_t i = 0; objects; objects.popFirst(), ++i )
+		{
+			QObject* obj = objects.getFirst().get();
+			if( !obj )
+				CORAL_THROW( co::IllegalArgumentException, "null object at position " << i );
+
+			const QMetaObject* metaObj = obj->metaObject();
+			if( metaObj != lastMetaObj )
+			{
+				int propertyIdx = getPropertyIndex( metaObj, name );
+				property = metaObj->property( propertyIdx );
+				lastMetaObj = metaObj;
+
+				// same conversion as Object.setProperty(): dynamic properties take any Qt type
+				int type = ( propertyIdx >= 0 ? static_cast<int>( property.type() ) : static_cast<int>( QMetaType::QVariant ) );
+				valueIdx = std::find( types.begin(), types.end(), type ) - types.begin();
+				if( valueIdx == types.size() )
+				{
+					types.push_back( type );
+					values.push_back( QVariant() );
+					anyToVariant( value, type, values.back() );
+				}
+			}
+
+			objs[i] = obj;
+			properties[i] = property;
+			valueIndexes[i] = valueIdx;
+		}
+
+		UpdatesGuard guard;
+		for( size_t i = 0; i < count; ++i )
+		{
+			QObject* obj = objs[i];
+			const QVariant& v = values[valueIndexes[i]];
+
+			if( count > 1 )
+				guard.add( obj );
+			if( properties[i].isValid() )
+				properties[i].write( obj, v );
+			else
+				obj->setProperty( internName( name ).bytes.constData(), v );
+
+			if( name == "objectName" )
+				ChildNameIndex::instance().invalidate( obj );
+		}
+	}
+
+	void invokeOnAll( co::Range<qt::Object const> objects, const std::string& methodSignature,
+					  const co::Any& a1, const co::Any& a2, const co::Any& a3, const co::Any& a4,
+					  const co::Any& a5, const co::Any& a6, const co::Any& a7 )
+	{
+		const co::Any* any[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7 };
+		QVariant var[InvokePlan::MAX_ARGS];
+		QGenericArgument arg[InvokePlan::MAX_ARGS];
+
+		UpdatesGuard guard;
+		bool batch = ( objects.getSize() > 1 );
+		const InvokePlan* plan = 0;
+		QMetaMethod method;
+
+		for( size_t i = 0; objects; objects.popFirst(), ++i )
+		{
+			QObject* obj = objects.getFirst().get();
+			if( !obj )
+				CORAL_THROW( co::IllegalArgumentException, "null object at position " << i );
+
+			const QMetaObject* metaObj = obj->metaObject();
+			if( !plan || plan->metaObject != metaObj )
+			{
+				const InvokePlan* previous = plan;
+				plan = &getInvokePlan( metaObj, methodSignature );
+				method = metaObj->method( plan->methodIndex );
+
+				// reconvert the arguments only if the parameter types changed
+				if( !previous || previous->argCount != plan->argCount ||
+					!std::equal( plan->argTypes, plan->argTypes + plan->argCount, previous->argTypes ) )
+					convertInvokeArguments( *plan, any, var, arg );
+			}
+
+			if( batch )
+				guard.add( obj );
+			if( !method.invoke( obj, arg[0], arg[1], arg[2], arg[3], arg[4], arg[5], arg[6] ) )
+				CORAL_THROW( co::IllegalArgumentException, "could not invoke " << metaObj->className() << "::" << methodSignature );
+		}
+	}
+
+	co::int32 addEventRoute( const qt::Object& root, const std::string& className, const std::string& objectNamePattern,
+							 co::Range<co::int32 const> eventTypes, qt::IDelegatedEventHandler* handler )
 	{
-		return _eventHub.installEventHandler( watched, handler );
+		return _eventRouter.addRoute( root, className, objectNamePattern, eventTypes, handler );
+	}
+
+	void removeEventRoute( co::int32 route )
+	{
+		_eventRouter.removeRoute( route );
 	}
 
 	void grabMouse( const qt::Object& widget, co::int32 cursor )
@@ -547,11 +715,57 @@ public:
 		return _connectionHub.connect( sender, signal, handler );
 	}
 
+	co::int32 connectThrottled( const qt::Object& sender, const std::string& signal, qt::IConnectionHandler* handler,
+								co::int32 intervalMs, co::int32 mode )
+	{
+		return _connectionHub.connectThrottled( sender, signal, handler, intervalMs, mode );
+	}
+
+	co::int32 connectBatched( const qt::Object& sender, const std::string& signal, qt::IBatchConnectionHandler* handler )
+	{
+		return _connectionHub.connectBatched( sender, signal, handler );
+	}
+
+	co::int32 connectQueued( const qt::Object& sender, const std::string& signal, qt::IConnectionHandler* handler )
+	{
+		return _connectionHub.connectQueued( sender, signal, handler );
+	}
+
 	void disconnect( co::int32 cookie )
 	{
 		_connectionHub.disconnect( cookie );
 	}
 
+	bool getEventCompressionEnabled()
+	{
+		return _eventHub.getCompressionEnabled();
+	}
+
+	void setEventCompressionEnabled( bool eventCompressionEnabled )
+	{
+		_eventHub.setCompressionEnabled( eventCompressionEnabled );
+	}
+
+	bool getConnectionStatsEnabled()
+	{
+		return _connectionHub.getStatsEnabled();
+	}
+
+	void setConnectionStatsEnabled( bool connectionStatsEnabled )
+	{
+		_connectionHub.setStatsEnabled( connectionStatsEnabled );
+	}
+
+	void getConnectionStats( std::vector<qt::ConnectionStats>& stats )
+	{
+		_connectionHub.getStats( stats );
+	}
+
+	void resetConnectionStats()
+	{
+		_connectionHub.resetStats();
+	}
+
 	co::int32 exec()
 	{
 		return _app->exec();
@@ -567,12 +781,81 @@ public:
 		_app->quit();
 	}
 
+private:
+	// the loader is created on first use, as it scans for designer plugins
+	QUiLoader& getUiLoader()
+	{
+		if( !_uiLoader )
+			_uiLoader = new QUiLoader;
+		return *_uiLoader;
+	}
+
+	/*
+		Returns the contents of a .ui file. The last few files loaded are kept in memory,
+		and only read again once their modification time or size changes (so windows
+		that are opened repeatedly are not read from disk every time).
+	 */
+	QByteArray& getUiContents( const QFileInfo& fi, const std::string& filePath )
+	{
+		QString path = fi.absoluteFilePath();
+		UiFileList::iterator it = _uiFiles.begin();
+		while( it != _uiFiles.end() && it->path != path )
+			++it;
+
+		// the list is kept in the order of use, so the least recently used file is evicted
+		if( it == _uiFiles.end() )
+		{
+			if( _uiFiles.size() >= MAX_CACHED_UI_FILES )
+				_uiFiles.pop_back();
+			_uiFiles.push_front( UiFile() );
+			_uiFiles.front().path = path;
+			_uiFiles.front().size = -1;
+		}
+		else if( it != _uiFiles.begin() )
+		{
+			_uiFiles.splice( _uiFiles.begin(), _uiFiles, it );
+		}
+
+		UiFile& entry = _uiFiles.front();
+		QDateTime lastModified = fi.lastModified();
+		if( entry.lastModified != lastModified || entry.size != fi.size() )
+		{
+			QFile uiFile( path );
+			if( !uiFile.open( QIODevice::ReadOnly ) )
+			{
+				_uiFiles.pop_front();
+				CORAL_THROW( qt::Exception, "could not open '" << filePath << "'" );
+			}
+
+			entry.contents = uiFile.readAll();
+			entry.lastModified = lastModified;
+			entry.size = fi.size();
+		}
+		return entry.contents;
+	}
+
 private:
 	QApplication* _app;
 	qt::Object _appObj;
 	EventHub _eventHub;
+	EventRouter _eventRouter;
 	ConnectionHub _connectionHub;
 	std::map<co::int32, Timer*> _timers;
+
+	QUiLoader* _uiLoader;
+
+	static const size_t MAX_CACHED_UI_FILES = 16;
+
+	struct UiFile
+	{
+		QString path; // absolute
+		QDateTime lastModified;
+		qint64 size;
+		QByteArray contents;
+	};
+
+	typedef std::list<UiFile> UiFileList;
+	UiFileList _uiFiles; // most recently used first
 };
 
 CORAL_EXPORT_COMPONENT( System, System )
@@ -0,0 +1,553 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#include "TreeItemStore.h"
+#include "ValueConverters.h"
+#include <qt/MimeData.h>
+#include <co/Range.h>
+#include <co/IllegalArgumentException.h>
+#include <algorithm>
+
+namespace
+{
+	const co::int32 ID_INVALID = -1;
+	const co::int32 DEFAULT_FLAGS = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+}
+
+namespace qt {
+
+TreeItemStore::TreeItemStore() : _owner( 0 ), _numColumns( 1 ), _numItems( 0 )
+{;}
+
+TreeItemStore::~TreeItemStore()
+{;}
+
+qt::IAbstractItemModel* TreeItemStore::getOwner()
+{
+	return _owner;
+}
+
+void TreeItemStore::setOwner( qt::IAbstractItemModel* owner )
+{
+	_owner = owner;
+}
+
+co::int32 TreeItemStore::getIndex( co::int32 row, co::int32 col, co::int32 parentIndex )
+{
+	if( col < 0 || col >= _numColumns || row < 0 )
+		return ID_INVALID;
+
+	if( parentIndex != ID_INVALID && ( !isValidIndex( parentIndex ) || parentIndex % _numColumns != 0 ) )
+		return ID_INVALID;
+
+	const ChildRuns& children = childrenOf( parentIndex );
+	if( row >= countChildren( children ) )
+		return ID_INVALID;
+
+	return childAt( children, row ) * _numColumns + col;
+}
+
+co::int32 TreeItemStore::getParentIndex( co::int32 index )
+{
+	if( !isValidIndex( index ) )
+		return ID_INVALID;
+
+	co::int32 parent = _nodes[nodeOf( index )].parent;
+	return parent == ID_INVALID ? ID_INVALID : parent * _numColumns;
+}
+
+bool TreeItemStore::setData( co::int32 index, const co::Any& data, co::int32 role )
+{
+	// edits are up to the edit delegate, which may update the store through setItemData()
+	return _editDelegate.get() ? _editDelegate->setData( index, data, role ) : false;
+}
+
+void TreeItemStore::getData( co::int32 index, co::int32 role, co::Any& data )
+{
+	const QVariant* value = findValue( index, role );
+	if( value )
+		variantToAny( *value, data );
+}
+
+bool TreeItemStore::getDataBlock( co::Range<const co::int32> indexes, co::Range<const co::int32> roles, std::vector<co::Any>& data )
+{
+	std::vector<co::int32> roleList;
+	for( ; !roles.isEmpty(); roles.popFirst() )
+		roleList.push_back( roles.getFirst() );
+
+	size_t roleCount = roleList.size();
+	data.resize( indexes.getSize() * roleCount );
+
+	size_t i = 0;
+	for( ; !indexes.isEmpty(); indexes.popFirst() )
+	{
+		for( size_t j = 0; j < roleCount; ++j, ++i )
+		{
+			const QVariant* value = findValue( indexes.getFirst(), roleList[j] );
+			if( value )
+				variantToAny( *value, data[i] );
+		}
+	}
+
+	return true;
+}
+
+co::int32 TreeItemStore::getFlags( co::int32 index )
+{
+	return _editDelegate.get() ? _editDelegate->getFlags( index ) : DEFAULT_FLAGS;
+}
+
+void TreeItemStore::getHorizontalHeaderData( co::int32 section, co::int32 role, co::Any& data )
+{
+	HeaderMap::const_iterator it = _headers.find( std::make_pair( section, role ) );
+	if( it != _headers.end() )
+		variantToAny( it->second, data );
+}
+
+void TreeItemStore::getVerticalHeaderData( co::int32 section, co::int32 role, co::Any& data )
+{
+	if( _editDelegate.get() )
+		_editDelegate->getVerticalHeaderData( section, role, data );
+}
+
+co::int32 TreeItemStore::getColumnCount( co::int32 )
+{
+	return _numColumns;
+}
+
+co::int32 TreeItemStore::getRowCount( co::int32 parentIndex )
+{
+	if( parentIndex == ID_INVALID )
+		return countChildren( _roots );
+
+	if( !isValidIndex( parentIndex ) || parentIndex % _numColumns != 0 )
+		return 0;
+
+	return countChildren( _nodes[nodeOf( parentIndex )].children );
+}
+
+bool TreeItemStore::hasChildren( co::int32 parentIndex )
+{
+	if( getRowCount( parentIndex ) > 0 )
+		return true;
+
+	// nodes whose children are loaded on demand by the edit delegate
+	return _editDelegate.get() && _editDelegate->canFetchMore( parentIndex );
+}
+
+bool TreeItemStore::canFetchMore( co::int32 parentIndex )
+{
+	return _editDelegate.get() ? _editDelegate->canFetchMore( parentIndex ) : false;
+}
+
+void TreeItemStore::fetchMore( co::int32 parentIndex )
+{
+	// the edit delegate appends the children to the store, which notifies the owner
+	if( _editDelegate.get() )
+		_editDelegate->fetchMore( parentIndex );
+}
+
+co::uint32 TreeItemStore::getRow( co::int32 index )
+{
+	return isValidIndex( index ) ? _nodes[nodeOf( index )].row : 0;
+}
+
+co::uint32 TreeItemStore::getColumn( co::int32 index )
+{
+	return isValidIndex( index ) ? index % _numColumns : 0;
+}
+
+void TreeItemStore::mimeData( co::Range<const co::int32> indexes, qt::MimeData& mimeData )
+{
+	if( _editDelegate.get() )
+		_editDelegate->mimeData( indexes, mimeData );
+}
+
+void TreeItemStore::mimeTypes( std::vector<std::string>& result )
+{
+	if( _editDelegate.get() )
+		_editDelegate->mimeTypes( result );
+}
+
+bool TreeItemStore::dropMimeData( const qt::MimeData& mimeData, co::int32 action, co::int32 row, co::int32 column, co::int32 parentIndex )
+{
+	if( !_editDelegate.get() )
+		return false;
+
+	return _editDelegate->dropMimeData( mimeData, action, row, column, parentIndex );
+}
+
+bool TreeItemStore::dropIndexes( qt::IAbstractItemModel* source, co::Range<const co::int32> indexes, co::int32 action,
+								 co::int32 row, co::int32 column, co::int32 parentIndex )
+{
+	if( !_editDelegate.get() )
+		return false;
+
+	return _editDelegate->dropIndexes( source, indexes, action, row, column, parentIndex );
+}
+
+co::int32 TreeItemStore::getNumColumns()
+{
+	return _numColumns;
+}
+
+void TreeItemStore::setNumColumns( co::int32 numColumns )
+{
+	if( numColumns < 1 )
+		CORAL_THROW( co::IllegalArgumentException, "illegal number of columns (" << numColumns << ")" );
+
+	if( _owner )
+		_owner->beginReset();
+
+	_numColumns = numColumns;
+	_numItems = 0;
+	_nodes.clear();
+	_roots.clear();
+	_cells.clear();
+	_freeNodes.clear();
+
+	if( _owner )
+		_owner->endReset();
+}
+
+co::int32 TreeItemStore::getNumItems()
+{
+	return _numItems;
+}
+
+co::int32 TreeItemStore::appendItems( co::int32 parentIndex, co::int32 count )
+{
+	co::int32 parentNode = checkParentIndex( parentIndex );
+	if( count < 1 )
+		CORAL_THROW( co::IllegalArgumentException, "illegal number of items (" << count << ")" );
+
+	co::int32 firstRow = countChildren( childrenOf( parentIndex ) );
+
+	// the new nodes stay dead (invisible to views) until they are linked below
+	co::int32 firstNode = allocateNodes( count );
+
+	// views query the current structure while handling beginInsertRows()
+	if( _owner )
+		_owner->beginInsertRows( parentIndex == ID_INVALID ? ID_INVALID : parentNode * _numColumns, firstRow, firstRow + count - 1 );
+
+	for( co::int32 i = 0; i < count; ++i )
+	{
+		Node& node = _nodes[firstNode + i];
+		node.parent = parentNode;
+		node.row = firstRow + i;
+		node.alive = true;
+	}
+
+	ChildRuns& children = childrenOf( parentIndex );
+	if( !children.empty() && children.back().firstNode + children.back().count == firstNode )
+	{
+		children.back().count += count;
+	}
+	else
+	{
+		ChildRun run = { firstNode, firstRow, count };
+		children.push_back( run );
+	}
+
+	_numItems += count;
+
+	if( _owner )
+		_owner->endInsertRows();
+
+	return firstNode * _numColumns;
+}
+
+void TreeItemStore::removeItems( co::int32 parentIndex, co::int32 firstRow, co::int32 count )
+{
+	co::int32 parentNode = checkParentIndex( parentIndex );
+	if( count < 1 )
+		return;
+
+	co::int32 rowCount = countChildren( childrenOf( parentIndex ) );
+	if( firstRow < 0 || firstRow + count > rowCount )
+		CORAL_THROW( co::IllegalArgumentException, "illegal row range [" << firstRow << ", "
+			<< firstRow + count - 1 << "] (parent has " << rowCount << " rows)" );
+
+	if( _owner )
+		_owner->beginRemoveRows( parentNode == ID_INVALID ? ID_INVALID : parentNode * _numColumns, firstRow, firstRow + count - 1 );
+
+	// re-fetch the children: the owner may have called back into the store
+	ChildRuns& siblings = childrenOf( parentIndex );
+	co::int32 endRow = firstRow + count;
+
+	// split the runs around the removed rows, moving up the rows that follow them
+	ChildRuns kept;
+	kept.reserve( siblings.size() + 1 );
+	for( size_t i = 0; i < siblings.size(); ++i )
+	{
+		const ChildRun& run = siblings[i];
+		co::int32 runEnd = run.firstRow + run.count;
+
+		if( run.firstRow < firstRow )
+		{
+			ChildRun head = { run.firstNode, run.firstRow, std::min( runEnd, firstRow ) - run.firstRow };
+			kept.push_back( head );
+		}
+
+		for( co::int32 row = std::max( run.firstRow, firstRow ); row < std::min( runEnd, endRow ); ++row )
+			_numItems -= killNode( run.firstNode + row - run.firstRow );
+
+		if( runEnd > endRow )
+		{
+			co::int32 from = std::max( run.firstRow, endRow );
+			ChildRun tail = { run.firstNode + from - run.firstRow, from - count, runEnd - from };
+			kept.push_back( tail );
+			for( co::int32 k = 0; k < tail.count; ++k )
+				_nodes[tail.firstNode + k].row = tail.firstRow + k;
+		}
+	}
+
+	siblings.swap( kept );
+	trimFreeNodes();
+
+	if( _owner )
+		_owner->endRemoveRows();
+}
+
+void TreeItemStore::clear()
+{
+	setNumColumns( _numColumns );
+}
+
+void TreeItemStore::setItemData( co::int32 index, co::int32 role, const co::Any& data )
+{
+	if( !isValidIndex( index ) )
+		CORAL_THROW( co::IllegalArgumentException, "invalid item index (" << index << ")" );
+
+	storeValue( index, role, data );
+	notifyDataChanged( index, index );
+}
+
+void TreeItemStore::setItemsData( co::int32 firstIndex, co::int32 role, co::Range<const co::Any> data )
+{
+	co::int32 count = static_cast<co::int32>( data.getSize() );
+	if( count == 0 )
+		return;
+
+	if( !isValidIndex( firstIndex ) || !isValidIndex( firstIndex + ( count - 1 ) * _numColumns ) )
+		CORAL_THROW( co::IllegalArgumentException, "invalid item range starting at index " << firstIndex
+			<< " (" << count << " items)" );
+
+	co::int32 index = firstIndex;
+	for( ; !data.isEmpty(); data.popFirst(), index += _numColumns )
+	{
+		if( _nodes[nodeOf( index )].alive )
+			storeValue( index, role, data.getFirst() );
+	}
+
+	if( !_owner )
+		return;
+
+	// notify runs of consecutive siblings with a single dataChanged() each
+	co::int32 runStart = firstIndex;
+	co::int32 runEnd = firstIndex;
+	for( index = firstIndex + _numColumns; index <= firstIndex + ( count - 1 ) * _numColumns; index += _numColumns )
+	{
+		const Node& node = _nodes[nodeOf( index )];
+		if( !node.alive )
+			continue;
+
+		const Node& last = _nodes[nodeOf( runEnd )];
+		if( node.parent != last.parent || node.row != last.row + 1 )
+		{
+			notifyDataChanged( runStart, runEnd );
+			runStart = index;
+		}
+		runEnd = index;
+	}
+	notifyDataChanged( runStart, runEnd );
+}
+
+void TreeItemStore::setHeaderData( co::int32 section, co::int32 role, const co::Any& data )
+{
+	QVariant& value = _headers[std::make_pair( section, role )];
+	anyToVariant( data, QMetaType::QVariant, value );
+}
+
+qt::IAbstractItemModelDelegate* TreeItemStore::getEditDelegateService()
+{
+	return _editDelegate.get();
+}
+
+void TreeItemStore::setEditDelegateService( qt::IAbstractItemModelDelegate* editDelegate )
+{
+	_editDelegate = editDelegate;
+}
+
+TreeItemStore::ChildRuns& TreeItemStore::childrenOf( co::int32 parentIndex )
+{
+	return parentIndex == ID_INVALID ? _roots : _nodes[nodeOf( parentIndex )].children;
+}
+
+co::int32 TreeItemStore::countChildren( const ChildRuns& children )
+{
+	return children.empty() ? 0 : children.back().firstRow + children.back().count;
+}
+
+co::int32 TreeItemStore::childAt( const ChildRuns& children, co::int32 row )
+{
+	// binary search for the last run starting at or before 'row'
+	size_t first = 0;
+	size_t last = children.size();
+	while( last - first > 1 )
+	{
+		size_t middle = ( first + last ) / 2;
+		if( children[middle].firstRow <= row )
+			first = middle;
+		else
+			last = middle;
+	}
+
+	const ChildRun& run = children[first];
+	return run.firstNode + row - run.firstRow;
+}
+
+co::int32 TreeItemStore::checkParentIndex( co::int32 parentIndex ) const
+{
+	if( parentIndex == ID_INVALID )
+		return ID_INVALID;
+
+	if( !isValidIndex( parentIndex ) )
+		CORAL_THROW( co::IllegalArgumentException, "invalid parent index (" << parentIndex << ")" );
+
+	return nodeOf( parentIndex );
+}
+
+void TreeItemStore::storeValue( co::int32 index, co::int32 role, const co::Any& data )
+{
+	QVariant value;
+	anyToVariant( data, QMetaType::QVariant, value );
+
+	RoleValues& values = _cells[index];
+	for( int i = 0; i < values.size(); ++i )
+	{
+		if( values[i].first == role )
+		{
+			values[i].second = value;
+			return;
+		}
+	}
+	values.push_back( qMakePair( static_cast<int>( role ), value ) );
+}
+
+const QVariant* TreeItemStore::findValue( co::int32 index, co::int32 role ) const
+{
+	if( !isValidIndex( index ) )
+		return 0;
+
+	const RoleValues& values = _cells[index];
+	for( int i = 0; i < values.size(); ++i )
+	{
+		if( values[i].first == role )
+			return &values[i].second;
+	}
+	return 0;
+}
+
+co::int32 TreeItemStore::allocateNodes( co::int32 count )
+{
+	// first fit among the runs of removed nodes
+	for( FreeRuns::iterator it = _freeNodes.begin(); it != _freeNodes.end(); ++it )
+	{
+		if( it->second < count )
+			continue;
+
+		co::int32 firstNode = it->first;
+		if( it->second > count )
+			_freeNodes.insert( std::make_pair( firstNode + count, it->second - count ) );
+		_freeNodes.erase( it );
+		return firstNode;
+	}
+
+	co::int32 firstNode = static_cast<co::int32>( _nodes.size() );
+	if( static_cast<qint64>( firstNode + count ) * _numColumns > 0x7FFFFFFF )
+		CORAL_THROW( co::IllegalArgumentException, "too many items in the store" );
+
+	_nodes.resize( firstNode + count );
+	_cells.resize( _nodes.size() * _numColumns );
+	return firstNode;
+}
+
+co::int32 TreeItemStore::killNode( co::int32 node )
+{
+	ChildRuns children;
+	children.swap( _nodes[node].children );
+	_nodes[node].alive = false;
+
+	co::int32 firstCell = node * _numColumns;
+	for( co::int32 c = 0; c < _numColumns; ++c )
+		_cells[firstCell + c].clear();
+
+	releaseNode( node );
+
+	co::int32 killed = 1;
+	for( size_t i = 0; i < children.size(); ++i )
+	{
+		for( co::int32 k = 0; k < children[i].count; ++k )
+			killed += killNode( children[i].firstNode + k );
+	}
+
+	return killed;
+}
+
+void TreeItemStore::releaseNode( co::int32 node )
+{
+	FreeRuns::iterator next = _freeNodes.upper_bound( node );
+	bool joinsNext = ( next != _freeNodes.end() && next->first == node + 1 );
+
+	if( next != _freeNodes.begin() )
+	{
+		FreeRuns::iterator previous = next;
+		--previous;
+		if( previous->first + previous->second == node )
+		{
+			previous->second += 1;
+			if( joinsNext )
+			{
+				previous->second += next->second;
+				_freeNodes.erase( next );
+			}
+			return;
+		}
+	}
+
+	co::int32 size = 1;
+	if( joinsNext )
+	{
+		size += next->second;
+		_freeNodes.erase( next );
+	}
+	_freeNodes.insert( std::make_pair( node, size ) );
+}
+
+void TreeItemStore::trimFreeNodes()
+{
+	if( _freeNodes.empty() )
+		return;
+
+	FreeRuns::iterator last = _freeNodes.end();
+	--last;
+	if( last->first + last->second != static_cast<co::int32>( _nodes.size() ) )
+		return;
+
+	_nodes.resize( last->first );
+	_cells.resize( _nodes.size() * _numColumns );
+	_freeNodes.erase( last );
+}
+
+void TreeItemStore::notifyDataChanged( co::int32 fromIndex, co::int32 toIndex )
+{
+	if( _owner )
+		_owner->notifyDataChanged( fromIndex, toIndex );
+}
+
+CORAL_EXPORT_COMPONENT( TreeItemStore, TreeItemStore )
+
+} // namespace qt
@@ -0,0 +1,150 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _TREEITEMSTORE_H_
+#define _TREEITEMSTORE_H_
+
+#include "TreeItemStore_Base.h"
+#include <qt/IAbstractItemModel.h>
+#include <qt/IAbstractItemModelDelegate.h>
+#include <co/RefPtr.h>
+#include <QVariant>
+#include <QVector>
+#include <QPair>
+#include <vector>
+#include <map>
+
+namespace qt {
+
+/*!
+	Keeps the structure and data of a tree in flat arrays. Each appendItems()
+	call gets a range of consecutive node numbers (reusing the nodes of removed
+	items when a large enough range is free), and the index of column 'c' of
+	node 'n' is n * numColumns + c. Only the first column of a node has children,
+	which are kept as runs of consecutive nodes rather than one entry per child.
+ */
+class TreeItemStore : public TreeItemStore_Base
+{
+public:
+	TreeItemStore();
+
+	virtual ~TreeItemStore();
+
+	// qt.IAbstractItemModelDelegate methods:
+	qt::IAbstractItemModel* getOwner();
+	void setOwner( qt::IAbstractItemModel* owner );
+
+	co::int32 getIndex( co::int32 row, co::int32 col, co::int32 parentIndex );
+	co::int32 getParentIndex( co::int32 index );
+	bool setData( co::int32 index, const co::Any& data, co::int32 role );
+	void getData( co::int32 index, co::int32 role, co::Any& data );
+	bool getDataBlock( co::Range<const co::int32> indexes, co::Range<const co::int32> roles, std::vector<co::Any>& data );
+	co::int32 getFlags( co::int32 index );
+	void getHorizontalHeaderData( co::int32 section, co::int32 role, co::Any& data );
+	void getVerticalHeaderData( co::int32 section, co::int32 role, co::Any& data );
+	co::int32 getColumnCount( co::int32 parentIndex );
+	co::int32 getRowCount( co::int32 parentIndex );
+	bool hasChildren( co::int32 parentIndex );
+	bool canFetchMore( co::int32 parentIndex );
+	void fetchMore( co::int32 parentIndex );
+	co::uint32 getRow( co::int32 index );
+	co::uint32 getColumn( co::int32 index );
+	void mimeData( co::Range<const co::int32> indexes, qt::MimeData& mimeData );
+	void mimeTypes( std::vector<std::string>& result );
+	bool dropMimeData( const qt::MimeData& mimeData, co::int32 action, co::int32 row, co::int32 column, co::int32 parentIndex );
+	bool dropIndexes( qt::IAbstractItemModel* source, co::Range<const co::int32> indexes, co::int32 action,
+					  co::int32 row, co::int32 column, co::int32 parentIndex );
+
+	// qt.ITreeItemStore methods:
+	co::int32 getNumColumns();
+	void setNumColumns( co::int32 numColumns );
+	co::int32 getNumItems();
+	co::int32 appendItems( co::int32 parentIndex, co::int32 count );
+	void removeItems( co::int32 parentIndex, co::int32 firstRow, co::int32 count );
+	void clear();
+	void setItemData( co::int32 index, co::int32 role, const co::Any& data );
+	void setItemsData( co::int32 firstIndex, co::int32 role, co::Range<const co::Any> data );
+	void setHeaderData( co::int32 section, co::int32 role, const co::Any& data );
+
+protected:
+	qt::IAbstractItemModelDelegate* getEditDelegateService();
+	void setEditDelegateService( qt::IAbstractItemModelDelegate* editDelegate );
+
+private:
+	// children at rows [firstRow, firstRow + count) that are consecutive nodes
+	struct ChildRun
+	{
+		co::int32 firstNode;
+		co::int32 firstRow;
+		co::int32 count;
+	};
+
+	typedef std::vector<ChildRun> ChildRuns; // sorted by row
+
+	struct Node
+	{
+		co::int32 parent; // parent node, or -1 for top-level nodes
+		co::int32 row;
+		bool alive;
+		ChildRuns children; // usually one run per appendItems() call
+	};
+
+	typedef QVector<QPair<int, QVariant> > RoleValues;
+
+	inline bool isValidIndex( co::int32 index ) const
+	{
+		return index >= 0 && index < static_cast<co::int32>( _cells.size() ) && _nodes[index / _numColumns].alive;
+	}
+
+	inline co::int32 nodeOf( co::int32 index ) const { return index / _numColumns; }
+
+	// gets the children of the node at 'parentIndex' (any column), or the top-level nodes if -1
+	ChildRuns& childrenOf( co::int32 parentIndex );
+
+	static co::int32 countChildren( const ChildRuns& children );
+
+	// returns the node of the child at 'row', which must be less than countChildren()
+	static co::int32 childAt( const ChildRuns& children, co::int32 row );
+
+	// returns the index of the first column of the node at 'index' (or -1 for -1)
+	co::int32 checkParentIndex( co::int32 parentIndex ) const;
+
+	void storeValue( co::int32 index, co::int32 role, const co::Any& data );
+	const QVariant* findValue( co::int32 index, co::int32 role ) const;
+
+	// returns the first of 'count' consecutive unused nodes, reusing removed nodes if possible
+	co::int32 allocateNodes( co::int32 count );
+
+	// marks a node and its descendants as removed, returning the number of nodes removed
+	co::int32 killNode( co::int32 node );
+
+	// adds a removed node to the free runs, merging it with its neighbours
+	void releaseNode( co::int32 node );
+
+	// shrinks the arrays if the last nodes were removed
+	void trimFreeNodes();
+
+	void notifyDataChanged( co::int32 fromIndex, co::int32 toIndex );
+
+private:
+	qt::IAbstractItemModel* _owner; // not a RefPtr: the owner keeps a reference to us
+	co::RefPtr<qt::IAbstractItemModelDelegate> _editDelegate;
+
+	co::int32 _numColumns;
+	co::int32 _numItems;
+	std::vector<Node> _nodes; // indexed by node number
+	ChildRuns _roots;
+	std::vector<RoleValues> _cells; // indexed by item index
+
+	typedef std::map<co::int32, co::int32> FreeRuns; // maps the first node of each run of removed nodes to its size
+	FreeRuns _freeNodes;
+
+	typedef std::map<std::pair<co::int32, co::int32>, QVariant> HeaderMap; // maps (section, role) to data
+	HeaderMap _headers;
+};
+
+} // namespace qt
+
+#endif // _TREEITEMSTORE_H_
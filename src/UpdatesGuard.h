@@ -0,0 +1,54 @@
+/*
+ * Coral Qt Module
+ * See copyright notice in LICENSE.md
+ */
+
+#ifndef _UPDATESGUARD_H_
+#define _UPDATESGUARD_H_
+
+#include <QWidget>
+#include <QPointer>
+#include <vector>
+
+/*!
+	Disables updates on the widgets passed to add() (and their children) until the
+	guard goes out of scope, so each widget is repainted once after a batch of changes.
+	Only the given widgets are affected: disabling updates on their windows would make
+	Qt walk and repaint the whole windows.
+ */
+class UpdatesGuard
+{
+public:
+	UpdatesGuard()
+	{
+		// empty
+	}
+
+	~UpdatesGuard()
+	{
+		for( size_t i = 0; i < _widgets.size(); ++i )
+		{
+			if( _widgets[i] )
+				_widgets[i]->setUpdatesEnabled( true );
+		}
+	}
+
+	//! Disables updates on \a obj, if it is a widget.
+	inline void add( QObject* obj )
+	{
+		if( !obj->isWidgetType() )
+			return;
+
+		QWidget* widget = static_cast<QWidget*>( obj );
+		if( !widget->updatesEnabled() )
+			return; // disabled by us (e.g. on a parent) or by someone else
+
+		widget->setUpdatesEnabled( false );
+		_widgets.push_back( widget );
+	}
+
+private:
+	std::vector<QPointer<QWidget> > _widgets;
+};
+
+#endif // _UPDATESGUARD_H_
@@ -4,81 +4,417 @@
  */
 
 #include "ValueConverters.h"
+#include "StringBridge.h"
 #include <co/Any.h>
+#include <co/IArray.h>
+#include <co/RefPtr.h>
 #include <co/IllegalCastException.h>
 #include <co/IllegalArgumentException.h>
 #include <qt/Variant.h>
+#include <qt/IValueConverter.h>
+#include <QStringList>
 #include <QVariant>
 #include <sstream>
+#include <vector>
 
 Q_DECLARE_METATYPE( Qt::Alignment )
-static const int s_QtAlignmentTypeId = qRegisterMetaType<Qt::Alignment>( "Qt::Alignment" );
+Q_DECLARE_METATYPE( QList<int> )
 
-void anyToVariant( const co::Any& any, int expectedTypeId, QVariant& var )
+namespace {
+
+/*
+	Converters are looked up in tables indexed by QMetaType id (for conversions to
+	or from a specific Qt type) and by Coral type kind (for anyToVariant() when any
+	Qt type will do).
+ */
+struct Converter
+{
+	Converter() : toVariant( 0 ), toAny( 0 ) {;}
+
+	inline bool canConvertToVariant() const { return toVariant || service.isValid(); }
+	inline bool canConvertToAny() const { return toAny || service.isValid(); }
+
+	AnyToVariantConverter toVariant;
+	VariantToAnyConverter toAny;
+	co::RefPtr<qt::IValueConverter> service; // used instead of the functions, if set
+};
+
+// enough for all co::TypeKind values
+const int MAX_KINDS = 32;
+
+class Registry
 {
-	switch( expectedTypeId )
+public:
+	Registry();
+
+	inline const Converter* find( int typeId ) const
 	{
-	case QMetaType::Void:
-		CORAL_THROW( co::IllegalArgumentException, "illegal Qt type '" << QMetaType::typeName( expectedTypeId ) << "'" );
-		return;
-	case QMetaType::Bool:
-		var.setValue( any.get<bool>() );
-		return;
-	case QMetaType::Int:
-		var.setValue( any.get<int>() );
-		return;
-	case QMetaType::UInt:
-		var.setValue( any.get<unsigned int>() );
-		return;
-	case QMetaType::Double:
-		var.setValue( any.get<double>() );
-		return;
-	case QMetaType::QString:
-		var.setValue<QString>( any.get<const std::string&>().c_str() );
-		return;
-	case QMetaType::QIcon:
-	case QMetaType::QSize:
-	case QMetaType::QFont:
-	case QMetaType::QPoint:
-	case QMetaType::QColor:
-	case QMetaType::QBrush:
-	case QMetaType::QVariant:
-		switch( any.getKind() )
-		{
-		case co::TK_NONE:		return;
-		case co::TK_BOOLEAN:	var.setValue( any.get<bool>() ); return;
-		case co::TK_INT8:		var.setValue( any.get<co::int8>() ); return;
-		case co::TK_UINT8:		var.setValue( any.get<co::uint8>() ); return;
-		case co::TK_INT16:		var.setValue( any.get<co::int16>() ); return;
-		case co::TK_UINT16:		var.setValue( any.get<co::uint16>() ); return;
-		case co::TK_INT32:		var.setValue( any.get<co::int32>() ); return;
-		case co::TK_UINT32:		var.setValue( any.get<co::uint32>() ); return;
-		case co::TK_INT64:		var.setValue( any.get<co::int64>() ); return;
-		case co::TK_UINT64:		var.setValue( any.get<co::uint64>() ); return;
-		case co::TK_FLOAT:		var.setValue( any.get<float>() ); return;
-		case co::TK_DOUBLE:		var.setValue( any.get<double>() ); return;
-		case co::TK_STRING:		var.setValue( QString( any.get<std::string&>().c_str() ) ); return;
-		case co::TK_NATIVECLASS:
+		return ( typeId > 0 && typeId < static_cast<int>( _types.size() ) ) ? &_types[typeId] : 0;
+	}
+
+	inline Converter& get( int typeId )
+	{
+		if( typeId >= static_cast<int>( _types.size() ) )
+			_types.resize( typeId + 1 );
+		return _types[typeId];
+	}
+
+	inline AnyToVariantConverter findKind( co::TypeKind kind ) const
+	{
+		return ( kind >= 0 && kind < MAX_KINDS ) ? _kinds[kind] : 0;
+	}
+
+	inline void setKind( co::TypeKind kind, AnyToVariantConverter toVariant )
+	{
+		assert( kind >= 0 && kind < MAX_KINDS );
+		_kinds[kind] = toVariant;
+	}
+
+	inline void clearServices()
+	{
+		for( size_t i = 0; i < _types.size(); ++i )
+			_types[i].service = 0;
+	}
+
+private:
+	std::vector<Converter> _types;
+	AnyToVariantConverter _kinds[MAX_KINDS];
+};
+
+inline Registry& registry()
+{
+	static Registry s_registry;
+	return s_registry;
+}
+
+inline co::TypeKind getElementKind( const co::Any& any )
+{
+	return static_cast<co::IArray*>( any.getType() )->getElementType()->getKind();
+}
+
+/****************************************************************************/
+/* co::Any to QVariant                                                      */
+/****************************************************************************/
+
+template<typename T>
+void valueToVariant( const co::Any& any, int, QVariant& var )
+{
+	var.setValue( any.get<T>() );
+}
+
+void noneToVariant( const co::Any&, int, QVariant& var )
+{
+	var = QVariant();
+}
+
+void stringToVariant( const co::Any& any, int, QVariant& var )
+{
+	var.setValue( toQString( any.get<const std::string&>() ) );
+}
+
+void byteArrayToVariant( const co::Any& any, int, QVariant& var )
+{
+	const std::string& bytes = any.get<const std::string&>();
+	var.setValue( QByteArray( bytes.data(), static_cast<int>( bytes.size() ) ) );
+}
+
+void nativeClassToVariant( const co::Any& any, int, QVariant& var )
+{
+	if( any.getType() != co::typeOf<qt::Variant>::get() )
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QVariant." );
+
+	var = any.get<qt::Variant&>();
+}
+
+// converts a single Coral value to the QVariant type that best matches its kind
+void kindToVariant( const co::Any& any, int, QVariant& var )
+{
+	AnyToVariantConverter converter = registry().findKind( any.getKind() );
+	if( !converter )
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QVariant." );
+
+	converter( any, QMetaType::QVariant, var );
+}
+
+void arrayToVariantList( const co::Any& any, QVariantList& list )
+{
+	switch( getElementKind( any ) )
+	{
+	case co::TK_ANY:
+		for( co::Range<const co::Any> r = any.get<co::Range<const co::Any> >(); r; r.popFirst() )
 		{
-			if( any.getType() == co::typeOf<qt::Variant>::get() )
-				var.setValue( any.get<qt::Variant&>() ); return;
-		}
-		default:
-			CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QVariant." );
-			return;
+			list.push_back( QVariant() );
+			kindToVariant( r.getFirst(), QMetaType::QVariant, list.back() );
 		}
+		break;
+	case co::TK_STRING:
+		for( co::Range<const std::string> r = any.get<co::Range<const std::string> >(); r; r.popFirst() )
+			list.push_back( toQString( r.getFirst() ) );
+		break;
+	case co::TK_BOOLEAN:
+		for( co::Range<const bool> r = any.get<co::Range<const bool> >(); r; r.popFirst() )
+			list.push_back( r.getFirst() );
+		break;
+	case co::TK_INT32:
+		for( co::Range<const co::int32> r = any.get<co::Range<const co::int32> >(); r; r.popFirst() )
+			list.push_back( r.getFirst() );
+		break;
+	case co::TK_DOUBLE:
+		for( co::Range<const double> r = any.get<co::Range<const double> >(); r; r.popFirst() )
+			list.push_back( r.getFirst() );
+		break;
+	default:
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QVariantList." );
+	}
+}
 
-	case QVariant::UserType:
-		// check our registered type
-		var = QVariant::fromValue( static_cast<Qt::Alignment>( any.get<co::int64>() ) );
-		if( var.userType() == s_QtAlignmentTypeId )
-			return;
+void variantListToVariant( const co::Any& any, int, QVariant& var )
+{
+	QVariantList list;
+	if( any.getKind() == co::TK_ARRAY )
+	{
+		arrayToVariantList( any, list );
+	}
+	else
+	{
+		list.push_back( QVariant() );
+		kindToVariant( any, QMetaType::QVariant, list.back() );
+	}
 
-	default:
-		CORAL_THROW( co::IllegalArgumentException, "no conversion from " << any << " to " << QMetaType::typeName( expectedTypeId ) );
+	var.setValue( list );
+}
+
+void stringListToVariant( const co::Any& any, int, QVariant& var )
+{
+	QStringList list;
+	if( any.getKind() == co::TK_STRING )
+	{
+		list.push_back( toQString( any.get<const std::string&>() ) );
+	}
+	else if( any.getKind() == co::TK_ARRAY && getElementKind( any ) == co::TK_STRING )
+	{
+		for( co::Range<const std::string> r = any.get<co::Range<const std::string> >(); r; r.popFirst() )
+			list.push_back( toQString( r.getFirst() ) );
+	}
+	else if( any.getKind() == co::TK_ARRAY && getElementKind( any ) == co::TK_ANY )
+	{
+		// e.g. Lua tables
+		for( co::Range<const co::Any> r = any.get<co::Range<const co::Any> >(); r; r.popFirst() )
+			list.push_back( toQString( r.getFirst().get<const std::string&>() ) );
+	}
+	else
+	{
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QStringList." );
+	}
+
+	var.setValue( list );
+}
+
+void intListToVariant( const co::Any& any, int, QVariant& var )
+{
+	co::TypeKind elementKind = ( any.getKind() == co::TK_ARRAY ? getElementKind( any ) : co::TK_NONE );
+	if( elementKind != co::TK_INT32 && elementKind != co::TK_ANY )
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QList<int>." );
+
+	QList<int> list;
+	if( elementKind == co::TK_INT32 )
+	{
+		for( co::Range<const co::int32> r = any.get<co::Range<const co::int32> >(); r; r.popFirst() )
+			list.push_back( r.getFirst() );
+	}
+	else
+	{
+		// e.g. Lua tables, whose numbers are doubles
+		for( co::Range<const co::Any> r = any.get<co::Range<const co::Any> >(); r; r.popFirst() )
+			list.push_back( r.getFirst().get<co::int32>() );
+	}
+
+	var.setValue( list );
+}
+
+// maps are flattened into arrays of key/value pairs
+void variantMapToVariant( const co::Any& any, int, QVariant& var )
+{
+	QVariantList pairs;
+	if( any.getKind() == co::TK_ARRAY )
+		arrayToVariantList( any, pairs );
+
+	if( any.getKind() != co::TK_ARRAY || pairs.size() % 2 != 0 )
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << any << " to a QVariantMap (expected key/value pairs)." );
+
+	QVariantMap map;
+	for( int i = 0; i < pairs.size(); i += 2 )
+		map.insert( pairs[i].toString(), pairs[i + 1] );
+
+	var.setValue( map );
+}
+
+// arrays of strings become QStringLists; other arrays, QVariantLists
+void arrayToVariant( const co::Any& any, int typeId, QVariant& var )
+{
+	if( getElementKind( any ) == co::TK_STRING )
+		stringListToVariant( any, typeId, var );
+	else
+		variantListToVariant( any, typeId, var );
+}
+
+void alignmentToVariant( const co::Any& any, int, QVariant& var )
+{
+	var = QVariant::fromValue( static_cast<Qt::Alignment>( any.get<co::int64>() ) );
+}
+
+/****************************************************************************/
+/* QVariant to co::Any                                                      */
+/****************************************************************************/
+
+template<typename T, typename CoralT>
+void variantToValue( const QVariant& var, co::Any& value )
+{
+	value.set( static_cast<CoralT>( var.value<T>() ) );
+}
+
+void variantToString( const QVariant& var, co::Any& value )
+{
+	assignUtf8( value.createString(), var.toString() );
+}
+
+void byteArrayToAny( const QVariant& var, co::Any& value )
+{
+	const QByteArray bytes = var.toByteArray();
+	value.createString().assign( bytes.constData(), bytes.size() );
+}
+
+void variantToComplex( const QVariant& var, co::Any& value )
+{
+	// sets a qt::Variant into co:Any
+	qt::Variant& variant = value.createComplexValue<qt::Variant>();
+	variant = var;
+}
+
+void stringListToAny( const QVariant& var, co::Any& value )
+{
+	const QStringList list = var.toStringList();
+	std::vector<std::string>& array = value.createArray<std::string>();
+	array.resize( list.size() );
+	for( int i = 0; i < list.size(); ++i )
+		assignUtf8( array[i], list[i] );
+}
+
+void intListToAny( const QVariant& var, co::Any& value )
+{
+	const QList<int> list = var.value<QList<int> >();
+	std::vector<co::int32>& array = value.createArray<co::int32>();
+	array.assign( list.begin(), list.end() );
+}
+
+void variantListToAny( const QVariant& var, co::Any& value )
+{
+	const QVariantList list = var.toList();
+	std::vector<co::Any>& array = value.createArray<co::Any>();
+	array.resize( list.size() );
+	for( int i = 0; i < list.size(); ++i )
+		variantToAny( list[i], array[i] );
+}
+
+void variantMapToAny( const QVariant& var, co::Any& value )
+{
+	const QVariantMap map = var.toMap();
+	std::vector<co::Any>& array = value.createArray<co::Any>();
+	array.resize( map.size() * 2 );
+
+	size_t i = 0;
+	for( QVariantMap::const_iterator it = map.begin(); it != map.end(); ++it, i += 2 )
+	{
+		assignUtf8( array[i].createString(), it.key() );
+		variantToAny( it.value(), array[i + 1] );
 	}
 }
 
+void alignmentToAny( const QVariant& var, co::Any& value )
+{
+	value.set( static_cast<co::int32>( var.value<Qt::Alignment>() ) );
+}
+
+Registry::Registry()
+{
+	for( int i = 0; i < MAX_KINDS; ++i )
+		_kinds[i] = 0;
+
+	// generic conversions, by kind
+	_kinds[co::TK_NONE]			= &noneToVariant;
+	_kinds[co::TK_BOOLEAN]		= &valueToVariant<bool>;
+	_kinds[co::TK_INT8]			= &valueToVariant<co::int8>;
+	_kinds[co::TK_UINT8]		= &valueToVariant<co::uint8>;
+	_kinds[co::TK_INT16]		= &valueToVariant<co::int16>;
+	_kinds[co::TK_UINT16]		= &valueToVariant<co::uint16>;
+	_kinds[co::TK_INT32]		= &valueToVariant<co::int32>;
+	_kinds[co::TK_UINT32]		= &valueToVariant<co::uint32>;
+	_kinds[co::TK_INT64]		= &valueToVariant<co::int64>;
+	_kinds[co::TK_UINT64]		= &valueToVariant<co::uint64>;
+	_kinds[co::TK_FLOAT]		= &valueToVariant<float>;
+	_kinds[co::TK_DOUBLE]		= &valueToVariant<double>;
+	_kinds[co::TK_STRING]		= &stringToVariant;
+	_kinds[co::TK_ARRAY]		= &arrayToVariant;
+	_kinds[co::TK_NATIVECLASS]	= &nativeClassToVariant;
+
+	// conversions to and from specific Qt types
+	Converter* c;
+	c = &get( QMetaType::QVariant );	c->toVariant = &kindToVariant;
+
+	c = &get( QMetaType::Bool );		c->toVariant = &valueToVariant<bool>;			c->toAny = &variantToValue<bool, bool>;
+	c = &get( QMetaType::Int );			c->toVariant = &valueToVariant<int>;			c->toAny = &variantToValue<int, co::int32>;
+	c = &get( QMetaType::UInt );		c->toVariant = &valueToVariant<unsigned int>;	c->toAny = &variantToValue<unsigned int, co::uint32>;
+	c = &get( QMetaType::LongLong );	c->toVariant = &valueToVariant<co::int64>;		c->toAny = &variantToValue<qlonglong, co::int64>;
+	c = &get( QMetaType::ULongLong );	c->toVariant = &valueToVariant<co::uint64>;		c->toAny = &variantToValue<qulonglong, co::uint64>;
+	c = &get( QMetaType::Float );		c->toVariant = &valueToVariant<float>;			c->toAny = &variantToValue<float, float>;
+	c = &get( QMetaType::Double );		c->toVariant = &valueToVariant<double>;			c->toAny = &variantToValue<double, double>;
+
+	c = &get( QMetaType::QString );		c->toVariant = &stringToVariant;		c->toAny = &variantToString;
+	c = &get( QMetaType::QChar );											c->toAny = &variantToString;
+	c = &get( QMetaType::QDate );											c->toAny = &variantToString;
+	c = &get( QMetaType::QTime );											c->toAny = &variantToString;
+	c = &get( QMetaType::QDateTime );										c->toAny = &variantToString;
+	c = &get( QMetaType::QByteArray );	c->toVariant = &byteArrayToVariant;		c->toAny = &byteArrayToAny;
+
+	c = &get( QMetaType::QStringList );	c->toVariant = &stringListToVariant;	c->toAny = &stringListToAny;
+	c = &get( QMetaType::QVariantList );	c->toVariant = &variantListToVariant;	c->toAny = &variantListToAny;
+	c = &get( QMetaType::QVariantMap );	c->toVariant = &variantMapToVariant;	c->toAny = &variantMapToAny;
+
+	const int complexTypes[] = { QMetaType::QIcon, QMetaType::QPixmap, QMetaType::QSize, QMetaType::QFont,
+								 QMetaType::QPoint, QMetaType::QColor, QMetaType::QBrush };
+	for( size_t i = 0; i < sizeof(complexTypes) / sizeof(int); ++i )
+	{
+		c = &get( complexTypes[i] );
+		c->toVariant = &kindToVariant;
+		c->toAny = &variantToComplex;
+	}
+
+	c = &get( qRegisterMetaType<QList<int> >( "QList<int>" ) );
+	c->toVariant = &intListToVariant;
+	c->toAny = &intListToAny;
+
+	c = &get( qRegisterMetaType<Qt::Alignment>( "Qt::Alignment" ) );
+	c->toVariant = &alignmentToVariant;
+	c->toAny = &alignmentToAny;
+
+	// properties of unregistered user types are assumed to be alignments (as they always were)
+	get( QVariant::UserType ).toVariant = &alignmentToVariant;
+}
+
+} // anonymous namespace
+
+void anyToVariant( const co::Any& any, int expectedTypeId, QVariant& var )
+{
+	const Converter* converter = registry().find( expectedTypeId );
+	if( !converter || !converter->canConvertToVariant() )
+		CORAL_THROW( co::IllegalArgumentException, "no conversion from " << any << " to " << QMetaType::typeName( expectedTypeId ) );
+
+	if( converter->service.isValid() )
+		converter->service->toVariant( any, var );
+	else
+		converter->toVariant( any, expectedTypeId, var );
+}
+
 void anyToVariant( const co::Any& any, const char* expectedTypeId, QVariant& var )
 {
 	int typeId = QMetaType::type( expectedTypeId );
@@ -87,31 +423,11 @@ void anyToVariant( const co::Any& any, const char* expectedTypeId, QVariant& var
 
 void variantToArgument( QVariant& var, QGenericArgument& arg )
 {
-	QVariant::Type type = var.type();
-	switch( type )
-	{
-	case QVariant::Bool:
-		arg = Q_ARG( bool, *reinterpret_cast<bool*>( var.data() ) );
-	case QVariant::Int:
-		arg = Q_ARG( int, *reinterpret_cast<int*>( var.data() ) );
-	case QVariant::UInt:
-		arg = Q_ARG( unsigned int, *reinterpret_cast<unsigned int*>( var.data() ) );
-	case QVariant::Double:
-		arg = Q_ARG( double, *reinterpret_cast<double*>( var.data() ) );
-	case QVariant::String:
-		arg = Q_ARG( QString, *reinterpret_cast<QString*>( var.data() ) );
-		break;
-	case QVariant::UserType:
-		// check our registered type
-		if( var.userType() == s_QtAlignmentTypeId )
-		{
-			arg = Q_ARG( Qt::Alignment, *reinterpret_cast<Qt::Alignment*>( var.data() ) );
-			break;
-		}
-	default:
-		CORAL_THROW( co::IllegalArgumentException, "no conversion from " << QMetaType::typeName( type ) << " to QGenericArgument" );
-		break;
-	}
+	if( !var.isValid() )
+		CORAL_THROW( co::IllegalArgumentException, "no conversion from an invalid QVariant to QGenericArgument" );
+
+	// QMetaMethod::invoke() matches arguments by type name, and only reads through the pointer
+	arg = QGenericArgument( QMetaType::typeName( var.userType() ), var.data() );
 }
 
 void variantToAny( const QVariant& v, co::Any& value )
@@ -122,37 +438,91 @@ void variantToAny( const QVariant& v, co::Any& value )
 		return;
 	}
 
-	QVariant::Type type = v.type();
-	switch( type )
+	const Converter* converter = registry().find( v.userType() );
+	if( !converter || !converter->canConvertToAny() )
+		CORAL_THROW( co::IllegalCastException, "cannot convert " << v.typeName() << " to a Coral any." );
+
+	if( converter->service.isValid() )
+		converter->service->toAny( v, value );
+	else
+		converter->toAny( v, value );
+}
+
+void registerValueConverters( int typeId, AnyToVariantConverter toVariant, VariantToAnyConverter toAny )
+{
+	if( typeId <= 0 )
+		CORAL_THROW( co::IllegalArgumentException, "illegal Qt type id (" << typeId << ")" );
+
+	Converter& converter = registry().get( typeId );
+	converter.toVariant = toVariant;
+	converter.toAny = toAny;
+	converter.service = 0;
+}
+
+void registerValueConverters( int typeId, qt::IValueConverter* service )
+{
+	registerValueConverters( typeId, 0, 0 );
+	registry().get( typeId ).service = service;
+}
+
+void registerKindConverter( co::TypeKind kind, AnyToVariantConverter toVariant )
+{
+	registry().setKind( kind, toVariant );
+}
+
+void clearServiceConverters()
+{
+	registry().clearServices();
+}
+
+namespace {
+
+template<typename T>
+void valueArgumentToAny( int, const void* arg, co::Any& value )
+{
+	value.set( *reinterpret_cast<const T*>( arg ) );
+}
+
+void stringArgumentToAny( int, const void* arg, co::Any& value )
+{
+	assignUtf8( value.createString(), *reinterpret_cast<const QString*>( arg ) );
+}
+
+void complexArgumentToAny( int typeId, const void* arg, co::Any& value )
+{
+	// sets a qt::Variant into co:Any
+	qt::Variant& variant = value.createComplexValue<qt::Variant>();
+	variant = QVariant( typeId, arg );
+}
+
+void genericArgumentToAny( int typeId, const void* arg, co::Any& value )
+{
+	variantToAny( QVariant( typeId, arg ), value );
+}
+
+} // anonymous namespace
+
+ArgumentToAnyConverter getArgumentToAnyConverter( int typeId )
+{
+	switch( typeId )
 	{
-	case QVariant::Bool:		value.set( v.toBool() ); break;
-	case QVariant::Int:			value.set( v.toInt() ); break;
-	case QVariant::UInt:		value.set( v.toUInt() ); break;
-	case QVariant::Double:		value.set( v.toDouble() ); break;
+	case QMetaType::Bool:		return &valueArgumentToAny<bool>;
+	case QMetaType::Int:		return &valueArgumentToAny<int>;
+	case QMetaType::UInt:		return &valueArgumentToAny<unsigned int>;
+	case QMetaType::Double:		return &valueArgumentToAny<double>;
+	case QMetaType::QString:	return &stringArgumentToAny;
+
+	case QMetaType::QIcon:
+	case QMetaType::QPixmap:
+	case QMetaType::QSize:
+	case QMetaType::QFont:
+	case QMetaType::QPoint:
+	case QMetaType::QColor:
+	case QMetaType::QBrush:
+		return &complexArgumentToAny;
 
-	case QVariant::Char:
-	case QVariant::String:
-	case QVariant::StringList:
-	case QVariant::ByteArray:
-	case QVariant::Date:
-	case QVariant::Time:
-	case QVariant::DateTime:
-		value.createString() = v.toString().toLatin1().data();
-		break;
-	case QVariant::Icon:
-	case QVariant::Size:
-	case QVariant::Font:
-	case QVariant::Point:
-	case QVariant::Color:
-	case QVariant::Brush:
-		{
-			// sets a qt::Variant into co:Any
-			qt::Variant& variant = value.createComplexValue<qt::Variant>();
-			variant = v;
-			break;
-		}
 	default:
-		CORAL_THROW( co::IllegalCastException, "cannot convert " << v.typeName() << " to a Coral any." );
-		break;
+		// less common types go through a temporary QVariant
+		return &genericArgumentToAny;
 	}
 }
@@ -7,12 +7,61 @@
 #define _VALUECONVERTERS_H_
 
 #include <co/Any.h>
+#include <co/TypeKind.h>
 #include <QVariant>
 #include <QGenericArgument>
 
+namespace qt {
+	class IValueConverter;
+}
+
 void anyToVariant( const co::Any& any, int expectedTypeId, QVariant& var );
 void anyToVariant( const co::Any& any, const char* expectedTypeId, QVariant& var );
 void variantToArgument( QVariant& var, QGenericArgument& arg );
 void variantToAny( const QVariant& v, co::Any& value );
 
+/*!
+	Converts a co::Any into a QVariant holding a value of the Qt type \a typeId
+	(or of any suitable Qt type, if \a typeId is QMetaType::QVariant).
+ */
+typedef void (*AnyToVariantConverter)( const co::Any& any, int typeId, QVariant& var );
+
+//! Converts a QVariant holding a value of the Qt type the converter was registered for into a co::Any.
+typedef void (*VariantToAnyConverter)( const QVariant& var, co::Any& value );
+
+/*!
+	Registers the converters for values of the Qt type \a typeId (a QMetaType id, e.g.
+	returned by qRegisterMetaType()), replacing the previous ones. Either converter may
+	be NULL if that direction is not supported. Must be called from the GUI thread.
+ */
+void registerValueConverters( int typeId, AnyToVariantConverter toVariant, VariantToAnyConverter toAny );
+
+//! Same as above, for converters implemented as a service (e.g. in another module or in Lua).
+void registerValueConverters( int typeId, qt::IValueConverter* converter );
+
+/*!
+	Releases all converters implemented as services, leaving their types without
+	conversions. Called when the ISystem is destroyed, as the services (e.g. Lua
+	closures) must not outlive the modules that implement them.
+ */
+void clearServiceConverters();
+
+/*!
+	Registers the converter used when any Qt type will do (i.e. when the expected type
+	is QMetaType::QVariant) for co::Any values of the given \a kind.
+ */
+void registerKindConverter( co::TypeKind kind, AnyToVariantConverter toVariant );
+
+/*!
+	Converts a raw Qt argument of type \a typeId (i.e. one of the pointers in the
+	arguments array received by qt_metacall()) into a co::Any.
+ */
+typedef void (*ArgumentToAnyConverter)( int typeId, const void* arg, co::Any& value );
+
+/*!
+	Returns the converter for raw arguments of the given Qt \a typeId.
+	Converters should be resolved once (e.g. at connection time) and reused.
+ */
+ArgumentToAnyConverter getArgumentToAnyConverter( int typeId );
+
 #endif // _VALUECONVERTERS_H_
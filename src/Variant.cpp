@@ -4,6 +4,7 @@
 #include <QBrush>
 #include <QColor>
 #include <ValueConverters.h>
+#include <StringBridge.h>
 
 namespace qt
 {
@@ -13,6 +14,11 @@ bool Variant_Adapter::isValid( qt::Variant& instance )
 	return instance.isValid();
 }
 
+bool Variant_Adapter::isNull( qt::Variant& instance )
+{
+	return instance.isNull();
+}
+
 void Variant_Adapter::setAny( qt::Variant& instance, const co::Any& value )
 {
 	qt::Variant v;
@@ -23,7 +29,7 @@ void Variant_Adapter::setAny( qt::Variant& instance, const co::Any& value )
 
 void Variant_Adapter::setIcon( qt::Variant& instance, const std::string& iconFilename )
 {
-	instance.setValue( QIcon( iconFilename.c_str() ) );
+	instance.setValue( QIcon( toQString( iconFilename ) ) );
 }
 
 void Variant_Adapter::setPoint( qt::Variant& instance, co::int32 x, co::int32 y )
@@ -48,7 +54,26 @@ void Variant_Adapter::setBrush( qt::Variant& instance, co::int32 r, co::int32 g,
 
 void Variant_Adapter::setFont( qt::Variant& instance, const std::string& family, co::int32 pointSize, co::int32 weight, bool italic )
 {
-	instance.setValue( QFont( family.c_str(), pointSize, weight, italic ) );
+	instance.setValue( QFont( toQString( family ), pointSize, weight, italic ) );
+}
+
+void Variant_Adapter::setAnyAs( qt::Variant& instance, const std::string& typeName, const co::Any& value )
+{
+	qt::Variant v;
+	anyToVariant( value, typeName.c_str(), v );
+
+	instance = v;
+}
+
+void Variant_Adapter::getAny( qt::Variant& instance, co::Any& value )
+{
+	variantToAny( instance, value );
+}
+
+bool Variant_Adapter::convert( qt::Variant& instance, const std::string& typeName )
+{
+	QVariant::Type type = QVariant::nameToType( typeName.c_str() );
+	return type != QVariant::Invalid && type != QVariant::UserType && instance.convert( type );
 }
 
 } // namespace qt
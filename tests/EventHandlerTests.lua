@@ -11,3 +11,100 @@ function testEventNotification()
 	testWidget:invoke( "close()" )
 	env.ASSERT_TRUE( hit, "The event was not called" )
 end
+
+function testEventSubscriptionsAccumulate()
+	local widget = qt.new( "QWidget" )
+	local shown, closed = false, false
+	widget.onShow = function() shown = true end
+	widget.onClose = function() closed = true end
+	widget.visible = true
+	widget:invoke( "close()" )
+	env.ASSERT_TRUE( shown, "The first installed event closure was not called" )
+	env.ASSERT_TRUE( closed, "The second installed event closure was not called" )
+end
+
+function testResizeEventsAreCompressed()
+	local widget = qt.new( "QWidget" )
+	local resizes, width = 0, 0
+	widget.onResize = function( sender, w, h ) resizes = resizes + 1; width = w end
+	widget.visible = true
+	qt.processEvents()
+	resizes = 0
+
+	qt.setEventCompressionEnabled( true )
+	widget.size = qt.Size( 200, 100 )
+	widget.size = qt.Size( 300, 100 )
+	env.ASSERT_EQ( resizes, 0, "A compressed event was dispatched before the event loop iteration" )
+	qt.processEvents()
+	qt.setEventCompressionEnabled( false )
+
+	env.ASSERT_EQ( resizes, 1, "The resize events were not merged" )
+	env.ASSERT_EQ( width, 300, "The merged resize event does not carry the final size" )
+end
+
+function testEventRoutesCoverObjectsCreatedLater()
+	local parent = qt.new( "QWidget" )
+	local hits = 0
+	local route = qt.addEventRoute( parent, "QWidget", "child*", { onShow = function( sender ) hits = hits + 1 end } )
+
+	local child = qt.new( "QWidget", parent )
+	child.objectName = "childWidget"
+	local other = qt.new( "QWidget", parent )
+	other.objectName = "otherWidget"
+	parent.visible = true
+
+	qt.removeEventRoute( route )
+	env.ASSERT_EQ( hits, 1, "The event route did not match only the child created after it" )
+end
+
+-- QEvent::Type values
+local KeyPress, Wheel = 6, 31
+
+function testWheelEventArguments()
+	local widget = qt.new( "QWidget" )
+	local x, y, delta
+	widget.onWheel = function( sender, wx, wy, wdelta ) x, y, delta = wx, wy, wdelta end
+
+	qt.sendEvent( widget, { type = Wheel, x = 10, y = 20, delta = 120 } )
+	env.ASSERT_EQ( x, 10, "The wheel event x coordinate is wrong" )
+	env.ASSERT_EQ( y, 20, "The wheel event y coordinate is wrong" )
+	env.ASSERT_EQ( delta, 120, "The wheel event delta is wrong" )
+end
+
+local RecordHandler = co.Component { name = "qt.tests.RecordHandler", provides = { handler = "qt.IEventRecordHandler" } }
+
+function RecordHandler.handler:onEvent( cookie, eventType )
+	self.boxedEvents = self.boxedEvents + 1
+	return true
+end
+
+function RecordHandler.handler:onEventRecord( cookie, record )
+	self.records[#self.records + 1] = { type = record.type, key = record.key, modifiers = record.modifiers,
+										x = record.x, y = record.y, delta = record.delta }
+	return true
+end
+
+function RecordHandler.handler:onObjectDestroyed( cookie )
+end
+
+function testEventRecordHandlersReceiveRecords()
+	local widget = qt.new( "QWidget" )
+	local instance = RecordHandler{ records = {}, boxedEvents = 0 }
+	qt.system:installEventRecordHandler( widget._obj, instance.handler, { KeyPress, Wheel }, 0 )
+
+	local shiftModifier = 0x02000000
+	qt.sendEvent( widget, { type = KeyPress, key = 0x41, modifiers = shiftModifier } )
+	qt.sendEvent( widget, { type = Wheel, x = 5, y = 7, delta = -120 } )
+	qt.system:removeEventHandler( widget._obj, instance.handler )
+
+	local records = instance.records
+	env.ASSERT_EQ( #records, 2, "The record handler was not called for each subscribed event" )
+	env.ASSERT_EQ( instance.boxedEvents, 0, "The record handler was also called through onEvent()" )
+	env.ASSERT_EQ( records[1].type, KeyPress, "The key record has the wrong type" )
+	env.ASSERT_EQ( records[1].key, 0x41, "The key record has the wrong key code" )
+	env.ASSERT_EQ( records[1].modifiers, shiftModifier, "The key record has the wrong modifiers" )
+	env.ASSERT_EQ( records[2].x, 5, "The wheel record has the wrong x coordinate" )
+	env.ASSERT_EQ( records[2].y, 7, "The wheel record has the wrong y coordinate" )
+	env.ASSERT_EQ( records[2].delta, -120, "The wheel record has the wrong delta" )
+	env.ASSERT_EQ( qt.system:getKeyName( 0x41 ), "Key_A", "The key name was not interned" )
+end
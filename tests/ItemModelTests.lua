@@ -0,0 +1,331 @@
+local env = require "testkit.env"
+
+local qt = require "qt"
+
+-- list model delegate over a table of strings, counting the data requests
+local ListDelegate = require( "qt.AbstractListModelDelegate" )( "qt.tests.ListDelegate" )
+
+function ListDelegate:getRow( index )
+	return index - 1
+end
+
+function ListDelegate:getRowCount( parentIndex )
+	if parentIndex == -1 then
+		return #self.items
+	end
+	return 0
+end
+
+function ListDelegate:getData( index, role )
+	if role == qt.DisplayRole then
+		self.dataRequests = self.dataRequests + 1
+		return self.items[index]
+	end
+	return nil
+end
+
+function ListDelegate:getFlags( index )
+	return qt.ItemIsSelectable + qt.ItemIsEnabled
+end
+
+function ListDelegate:getHorizontalHeaderData( section, role )
+	return nil
+end
+
+function ListDelegate:getVerticalHeaderData( section, role )
+	return nil
+end
+
+-- dragged items are serialized as records; the indexes of same-process drops are
+-- accepted directly if 'acceptIndexes' is set
+local ITEMS_MIME_TYPE = "application/x-coral-qt-test-items"
+
+function ListDelegate:mimeTypes()
+	return { ITEMS_MIME_TYPE }
+end
+
+function ListDelegate:mimeData( indexes, mimeData )
+	self.mimeDataCalls = self.mimeDataCalls + 1
+	local items = {}
+	for i, index in ipairs( indexes ) do
+		items[i] = self.items[index]
+	end
+	mimeData:setRecords( ITEMS_MIME_TYPE, items )
+	return mimeData
+end
+
+function ListDelegate:dropIndexes( source, indexes, action, row, column, parentIndex )
+	if not self.acceptIndexes then
+		return false
+	end
+	self.dropped = { indexes = indexes }
+	return true
+end
+
+function ListDelegate:dropMimeData( mimeData, action, row, column, parentIndex )
+	local dropped = { hasItems = mimeData:hasFormat( ITEMS_MIME_TYPE ) }
+	dropped.ids = mimeData:getIndexes( qt.ItemIndexesMimeType )
+	dropped.serializedBeforeRead = self.source.mimeDataCalls
+	dropped.records = mimeData:getRecords( ITEMS_MIME_TYPE )
+	dropped.recordsReadAgain = mimeData:getRecords( ITEMS_MIME_TYPE )
+	self.dropped = dropped
+	return true
+end
+
+local function newListModel( items, dataCacheSize )
+	local delegate = ListDelegate{ items = items, dataRequests = 0, mimeDataCalls = 0 }
+	local model = co.new( "qt.AbstractItemModel" ).itemModel
+	model.dataCacheSize = dataCacheSize or 0
+	model.delegate = delegate.delegate
+	return model, delegate
+end
+
+-- requests the index and the display data of every row, as views do before painting
+local function readAllRows( view )
+	view:invoke( "keyboardSearch(QString)", "no such item" )
+end
+
+function testCachedDataSurvivesGenerationSwaps()
+	-- a cache of 4 items keeps generations of 2 items, so reading 3 rows swaps them
+	local model, delegate = newListModel( { "one", "two", "three" }, 4 )
+	local view = qt.new( "QListView" )
+	view:setModel( model )
+
+	readAllRows( view )
+	env.ASSERT_EQ( delegate.dataRequests, 3, "data of each row requested once" )
+
+	-- the items in the old generation are promoted back with their data
+	readAllRows( view )
+	env.ASSERT_EQ( delegate.dataRequests, 3, "cached data requested again" )
+end
+
+function testTreeItemStoreStructure()
+	local items = co.new( "qt.TreeItemStore" )
+	local store, delegate = items.store, items.delegate
+	store.numColumns = 2
+
+	local first = store:appendItems( -1, 3 )
+	store:setItemsData( first, qt.DisplayRole, { "a", "b", "c" } )
+	env.ASSERT_EQ( delegate:getRowCount( -1 ), 3 )
+	env.ASSERT_EQ( delegate:getIndex( 2, 1, -1 ), first + 5 )
+	env.ASSERT_EQ( delegate:getData( first + 4, qt.DisplayRole ), "c" )
+
+	-- children of the second node
+	local child = store:appendItems( first + 2, 2 )
+	env.ASSERT_EQ( store.numItems, 5 )
+	env.ASSERT_EQ( delegate:getRowCount( first + 2 ), 2 )
+	env.ASSERT_EQ( delegate:getIndex( 1, 0, first + 2 ), child + 2 )
+	env.ASSERT_EQ( delegate:getParentIndex( child + 3 ), first + 2 )
+
+	-- removing a node moves up its next siblings
+	store:removeItems( -1, 0, 1 )
+	env.ASSERT_EQ( store.numItems, 4 )
+	env.ASSERT_EQ( delegate:getIndex( 0, 0, -1 ), first + 2 )
+	env.ASSERT_EQ( delegate:getRow( first + 4 ), 1 )
+
+	-- removing a node removes its children
+	store:removeItems( -1, 0, 1 )
+	env.ASSERT_EQ( store.numItems, 1 )
+	env.ASSERT_EQ( delegate:getParentIndex( child ), -1 )
+	env.ASSERT_EQ( delegate:getData( first + 4, qt.DisplayRole ), "c" )
+end
+
+function testTreeItemStoreReusesRemovedNodes()
+	local items = co.new( "qt.TreeItemStore" )
+	local store, delegate = items.store, items.delegate
+
+	local first = store:appendItems( -1, 10 )
+	local last = store:appendItems( -1, 10 )
+	store:setItemData( first, qt.DisplayRole, "removed" )
+	store:removeItems( -1, 0, 10 )
+
+	-- the indexes of the removed nodes are given to the next appends that fit
+	env.ASSERT_EQ( store:appendItems( -1, 4 ), first )
+	env.ASSERT_EQ( store:appendItems( -1, 6 ), first + 4 )
+	env.ASSERT_EQ( store:appendItems( -1, 1 ), last + 10 )
+	env.ASSERT_EQ( delegate:getData( first, qt.DisplayRole ), nil )
+	env.ASSERT_EQ( delegate:getRow( first ), 10 )
+	env.ASSERT_EQ( delegate:getRowCount( -1 ), 21 )
+
+	-- removing and appending the last nodes does not grow the store
+	for i = 1, 100 do
+		store:removeItems( -1, 20, 1 )
+		env.ASSERT_EQ( store:appendItems( -1, 1 ), last + 10 )
+	end
+end
+
+-- edit delegate of a TreeItemStore that loads the children of top-level nodes on demand
+local LazyLoader = require( "qt.AbstractItemModelDelegate" )( "qt.tests.LazyLoader" )
+
+function LazyLoader:canFetchMore( parentIndex )
+	return self.lazy[parentIndex] == true
+end
+
+function LazyLoader:fetchMore( parentIndex )
+	self.lazy[parentIndex] = false
+	self.fetches = self.fetches + 1
+	local first = self.store:appendItems( parentIndex, 2 )
+	self.store:setItemsData( first, qt.DisplayRole, { "child 1", "child 2" } )
+end
+
+function testChildrenAreFetchedOnDemand()
+	local items = co.new( "qt.TreeItemStore" )
+	local loader = LazyLoader{ store = items.store, lazy = {}, fetches = 0 }
+	items.editDelegate = loader.delegate
+
+	local first = items.store:appendItems( -1, 2 )
+	loader.lazy[first] = true
+	loader.lazy[first + 1] = true
+
+	-- unloaded nodes have children, which are not counted yet
+	env.ASSERT_TRUE( items.delegate:hasChildren( first ) )
+	env.ASSERT_EQ( items.delegate:getRowCount( first ), 0 )
+
+	local model = co.new( "qt.AbstractItemModel" ).itemModel
+	model.delegate = items.delegate
+	local view = qt.new( "QTreeView" )
+	view:setModel( model )
+
+	-- expanding the nodes makes the view fetch their children
+	view:invoke( "expandAll()" )
+	env.ASSERT_EQ( loader.fetches, 2 )
+	env.ASSERT_EQ( items.store.numItems, 6 )
+	env.ASSERT_EQ( items.delegate:getRowCount( first + 1 ), 2 )
+
+	-- loaded nodes are not fetched again
+	view:invoke( "collapseAll()" )
+	view:invoke( "expandAll()" )
+	env.ASSERT_EQ( loader.fetches, 2 )
+end
+
+-- returns the source rows shown by a view of a proxy
+local function visibleRows( view, model )
+	view:invoke( "selectAll()" )
+	local ranges = model:getSelectionRanges()
+	view:invoke( "clearSelection()" )
+	return ranges
+end
+
+function testSortFilterProxyModelFiltering()
+	local model, delegate = newListModel( { "apple", "banana", "cherry", "apricot", "grape" } )
+	local proxy = qt.newSortFilterProxyModel( model )
+	local view = qt.new( "QListView" )
+	view:setModel( proxy )
+
+	proxy.filterText = "A"
+	local ranges = visibleRows( view, model )
+	env.ASSERT_EQ( #ranges, 6, "two ranges of source rows" )
+	env.ASSERT_EQ( table.concat( ranges, " " ), "-1 0 1 -1 3 4" )
+	local requests = delegate.dataRequests
+
+	-- a longer text only checks the rows shown, with the keys cached by the proxy
+	proxy.filterText = "ap"
+	env.ASSERT_EQ( table.concat( visibleRows( view, model ), " " ), "-1 0 0 -1 3 4" )
+	env.ASSERT_EQ( delegate.dataRequests, requests, "data requested again while narrowing" )
+
+	proxy.filterText = "apr"
+	env.ASSERT_EQ( table.concat( visibleRows( view, model ), " " ), "-1 3 3" )
+
+	-- the selection is reported in source ids, and source selections are shown by the view
+	proxy.filterText = "an"
+	view:invoke( "selectAll()" )
+	local selection = model:getSelection()
+	env.ASSERT_EQ( #selection, 1 )
+	env.ASSERT_EQ( selection[1], 2, "id of 'banana'" )
+	env.ASSERT_EQ( model:getSelectedRowCount(), 1 )
+
+	model:clearSelection()
+	proxy.filterText = ""
+	model:selectRows( -1, 3, 4, qt.Select )
+	env.ASSERT_EQ( table.concat( model:getSelectionRanges(), " " ), "-1 3 4" )
+end
+
+function testDraggedItemsAreSerializedOnDemand()
+	local model, delegate = newListModel( { "one", "two", "three" } )
+	local target, targetDelegate = newListModel( {} )
+	targetDelegate.source = delegate
+
+	-- same-process drops hand the item ids over, without serializing the items
+	targetDelegate.acceptIndexes = true
+	env.ASSERT_TRUE( model:dropItems( { 1, 3 }, target, qt.MoveAction, 0, 0, -1 ) )
+	env.ASSERT_EQ( table.concat( targetDelegate.dropped.indexes, " " ), "1 3" )
+	env.ASSERT_EQ( delegate.mimeDataCalls, 0, "items serialized for a direct drop" )
+
+	-- declined drops fall back to dropMimeData(), which gets the ids as recorded by the model
+	targetDelegate.acceptIndexes = false
+	env.ASSERT_TRUE( model:dropItems( { 1, 3 }, target, qt.MoveAction, 0, 0, -1 ) )
+	local dropped = targetDelegate.dropped
+	env.ASSERT_TRUE( dropped.hasItems, "format of the delegate not announced" )
+	env.ASSERT_EQ( table.concat( dropped.ids, " " ), "1 3" )
+	env.ASSERT_EQ( dropped.serializedBeforeRead, 0, "items serialized before their data was read" )
+
+	-- the items are serialized once, when their data is first read
+	env.ASSERT_EQ( table.concat( dropped.records, " " ), "one three" )
+	env.ASSERT_EQ( table.concat( dropped.recordsReadAgain, " " ), "one three" )
+	env.ASSERT_EQ( delegate.mimeDataCalls, 1, "items serialized more than once" )
+end
+
+-- delegate of a single item, whose drag data is written and read back by the given closures
+local PayloadDelegate = require( "qt.AbstractListModelDelegate" )( "qt.tests.PayloadDelegate" )
+
+function PayloadDelegate:getRowCount( parentIndex )
+	return parentIndex == -1 and 1 or 0
+end
+
+function PayloadDelegate:mimeData( indexes, mimeData )
+	self.write( mimeData )
+	return mimeData
+end
+
+function PayloadDelegate:dropMimeData( mimeData, action, row, column, parentIndex )
+	self.result = self.read( mimeData )
+	return true
+end
+
+-- drags the item onto its own model, and returns what was read from the drag data
+local function roundTrip( write, read )
+	local delegate = PayloadDelegate{ write = write, read = read }
+	local model = co.new( "qt.AbstractItemModel" ).itemModel
+	model.delegate = delegate.delegate
+	env.ASSERT_TRUE( model:dropItems( { 1 }, model, qt.CopyAction, 0, 0, -1 ) )
+	return delegate.result
+end
+
+function testMimeDataPayloads()
+	local bytes = "\0\1\255 raw"
+	local result = roundTrip( function( mimeData )
+		mimeData:setBytes( "test/bytes", bytes )
+		mimeData:setBytes( "test/no-bytes", "" )
+		mimeData:setIndexes( "test/indexes", { -1, 0, 7, 2147483647 } )
+		mimeData:setIndexes( "test/no-indexes", {} )
+		mimeData:setRecords( "test/records", { "first", "", "ação\0" } )
+		mimeData:setRecords( "test/no-records", {} )
+		mimeData:setData( "test/strings", { "ação", "窓", "" } )
+
+		-- a payload cut in the middle of its second record
+		mimeData:setRecords( "test/full-records", { "abc", "defgh" } )
+		local full = mimeData:getBytes( "test/full-records" )
+		mimeData:setBytes( "test/truncated-records", full:sub( 1, #full - 2 ) )
+	end, function( mimeData )
+		return {
+			bytes = mimeData:getBytes( "test/bytes" ),
+			noBytes = mimeData:getBytes( "test/no-bytes" ),
+			indexes = mimeData:getIndexes( "test/indexes" ),
+			noIndexes = mimeData:getIndexes( "test/no-indexes" ),
+			records = mimeData:getRecords( "test/records" ),
+			noRecords = mimeData:getRecords( "test/no-records" ),
+			truncatedRecords = mimeData:getRecords( "test/truncated-records" ),
+			strings = mimeData:getData( "test/strings" ),
+		}
+	end )
+
+	env.ASSERT_EQ( result.bytes, bytes )
+	env.ASSERT_EQ( result.noBytes, "" )
+	env.ASSERT_EQ( table.concat( result.indexes, " " ), "-1 0 7 2147483647" )
+	env.ASSERT_EQ( #result.noIndexes, 0 )
+	env.ASSERT_EQ( #result.records, 3 )
+	env.ASSERT_EQ( table.concat( result.records, "|" ), "first||ação\0" )
+	env.ASSERT_EQ( #result.noRecords, 0 )
+	env.ASSERT_EQ( table.concat( result.truncatedRecords, "|" ), "abc", "only the complete records are read" )
+	env.ASSERT_EQ( table.concat( result.strings, "|" ), "ação|窓|" )
+end
@@ -29,3 +29,146 @@ function multipleLuaFunctionCouldBeUsedAsSlotsTest()
 
 	env.ASSERT_EQ( hits, 3, "2 slots where connected to a signal but they where not both signaled." )
 end
+
+local function processEventsUntil( condition, timeout )
+	local start = os.clock()
+	while not condition() and os.clock() - start < ( timeout or 1 ) do
+		qt.processEvents()
+	end
+end
+
+function throttledConnectionsCollapseEmissionsTest()
+	local w = qt.loadUi( "coral:../tests/resources/TestWindow.ui" )
+	local hits, lastState = 0, nil
+	w.checkBox:connectThrottled( "toggled(bool)", 10, qt.ThrottleLatest, function( sender, checked )
+		hits = hits + 1
+		lastState = checked
+	end )
+
+	w.checkBox.checked = true
+	w.checkBox.checked = false
+	w.checkBox.checked = true
+	env.ASSERT_EQ( hits, 0, "A throttled connection was signaled before its interval elapsed." )
+
+	processEventsUntil( function() return hits > 0 end )
+	env.ASSERT_EQ( hits, 1, "The emissions within the interval were not collapsed into a single call." )
+	env.ASSERT_TRUE( lastState, "The throttled call did not carry the arguments of the last emission." )
+end
+
+function disconnectedCookiesAreRecycledTest()
+	local w = qt.loadUi( "coral:../tests/resources/TestWindow.ui" )
+	local hits = 0
+	local cookie = w.checkBox:connect( "toggled(bool)", function() hits = hits + 1 end )
+	qt.disconnect( cookie )
+
+	w.checkBox.checked = not w.checkBox.checked
+	env.ASSERT_EQ( hits, 0, "A removed connection was still signaled." )
+
+	local newCookie = w.checkBox:connect( "toggled(bool)", function() hits = hits + 2 end )
+	env.ASSERT_EQ( newCookie, cookie, "The cookie of the removed connection was not recycled." )
+
+	w.checkBox.checked = not w.checkBox.checked
+	env.ASSERT_EQ( hits, 2, "The connection using a recycled cookie did not call its own closure." )
+end
+
+function batchedConnectionsDeliverAllEmissionsOnceProcessedTest()
+	local w = qt.loadUi( "coral:../tests/resources/TestWindow.ui" )
+	local states = {}
+	w.checkBox:connectBatched( "toggled(bool)", function( sender, checked )
+		states[#states + 1] = checked
+	end )
+
+	w.checkBox.checked = true
+	w.checkBox.checked = false
+	w.checkBox.checked = true
+	env.ASSERT_EQ( #states, 0, "A batched connection was signaled before the event loop iteration." )
+
+	processEventsUntil( function() return #states > 0 end )
+	env.ASSERT_EQ( #states, 3, "Not all queued emissions were delivered in the batch." )
+	env.ASSERT_TRUE( states[1] and not states[2] and states[3], "The batch did not preserve the emission order and arguments." )
+end
+
+function connectionStatsCountEmissionsAndHandlerCallsTest()
+	local w = qt.loadUi( "coral:../tests/resources/TestWindow.ui" )
+	local cookie = w.checkBox:connect( "toggled(bool)", function() end )
+
+	qt.setConnectionStatsEnabled( true )
+	qt.resetConnectionStats()
+	w.checkBox.checked = true
+	w.checkBox.checked = false
+	qt.setConnectionStatsEnabled( false )
+	w.checkBox.checked = true
+
+	local found = nil
+	for i, stats in ipairs( qt.getConnectionStats() ) do
+		if stats.cookie == cookie then found = stats end
+	end
+
+	env.ASSERT_TRUE( found, "No statistics were returned for an existing connection." )
+	env.ASSERT_EQ( found.emissionCount, 2, "Emissions were not counted only while statistics were enabled." )
+	env.ASSERT_EQ( found.dispatchCount, 2, "Handler calls were not counted." )
+
+	local histogramCalls = 0
+	for i, count in ipairs( found.latencyHistogram ) do
+		histogramCalls = histogramCalls + count
+	end
+	env.ASSERT_EQ( histogramCalls, 2, "The latency histogram does not account for all handler calls." )
+
+	qt.disconnect( cookie )
+end
+
+-- deferred deletions only run inside an event loop
+local function deleteLater( wrapper )
+	wrapper:invoke( "deleteLater()" )
+	local timer = require( "qt.Timer" )( function() qt.quit() end )
+	timer:start( 0 )
+	qt.exec()
+	timer:stop()
+end
+
+-- connection handler that records the calls it gets
+local RecordingHandler = co.Component { name = "qt.tests.RecordingHandler", provides = { handler = "qt.IConnectionHandler" } }
+
+function RecordingHandler.handler:onSignal( cookie )
+	self.calls[#self.calls + 1] = "onSignal"
+end
+
+function RecordingHandler.handler:onSenderDestroyed( cookie )
+	self.calls[#self.calls + 1] = "onSenderDestroyed"
+end
+
+function connectionsToDestroyedOfATrackedSenderAreSafeTest()
+	local w = qt.loadUi( "coral:../tests/resources/TestWindow.ui" )
+	local clicks = 0
+	w.btnOk:connect( "clicked()", function() clicks = clicks + 1 end )
+	local recorder = RecordingHandler{ calls = {} }
+	qt.system:connect( w.btnOk._obj, "destroyed()", recorder.handler )
+
+	-- the sender's destruction signals destroyed() once, then removes both connections
+	deleteLater( w.btnOk )
+	env.ASSERT_EQ( clicks, 0, "A connection was signaled by the sender's destruction." )
+	env.ASSERT_EQ( table.concat( recorder.calls, " " ), "onSignal onSenderDestroyed",
+		"The destroyed() connection was not signaled once before its removal." )
+end
+
+function queuedConnectionsAreCalledLaterTest()
+	local w = qt.loadUi( "coral:../tests/resources/TestWindow.ui" )
+	local states = {}
+	local cookie = w.checkBox:connectQueued( "toggled(bool)", function( sender, checked )
+		states[#states + 1] = checked
+	end )
+
+	w.checkBox.checked = true
+	w.checkBox.checked = false
+	env.ASSERT_EQ( #states, 0, "A queued connection was signaled synchronously." )
+
+	processEventsUntil( function() return #states > 1 end )
+	env.ASSERT_EQ( #states, 2, "Not all queued emissions were delivered." )
+	env.ASSERT_TRUE( states[1] and not states[2], "The queue did not preserve the emission order and arguments." )
+
+	-- emissions of a removed connection are discarded
+	w.checkBox.checked = true
+	qt.disconnect( cookie )
+	processEventsUntil( function() return #states > 2 end, 0.1 )
+	env.ASSERT_EQ( #states, 2, "An emission of a removed connection was delivered." )
+end
@@ -14,3 +14,111 @@ function testSingletonWrapperInstances()
 	-- checks whether the same ObjectWrapper is returned everytime
 	env.ASSERT_TRUE( testWidget.btnOk == testWidget.btnOk )
 end
+
+function testBatchProperties()
+	testWidget.btnOk:setProperties{ text = "Apply", enabled = false }
+	local props = testWidget.btnOk:getProperties{ "text", "enabled", "noSuchProperty" }
+	env.ASSERT_EQ( props.text, "Apply" )
+	env.ASSERT_EQ( props.enabled, false )
+	env.ASSERT_EQ( props.noSuchProperty, nil )
+
+	qt.applyProperty( { testWidget.btnOk, testWidget.checkBox }, "enabled", true )
+	env.ASSERT_TRUE( testWidget.btnOk.enabled )
+	env.ASSERT_TRUE( testWidget.checkBox.enabled )
+
+	qt.invokeOnAll( { testWidget.btnOk, testWidget.checkBox }, "setEnabled(bool)", false )
+	env.ASSERT_EQ( testWidget.btnOk.enabled, false )
+	env.ASSERT_EQ( testWidget.checkBox.enabled, false )
+end
+
+function testContainerConversions()
+	local v = co.new( "qt.Variant" )
+	v:setAnyAs( "QStringList", { "a", "b" } )
+	env.ASSERT_EQ( table.concat( v:getAny(), "," ), "a,b" )
+
+	v:setAnyAs( "QList<int>", { 3, 1, 2 } )
+	env.ASSERT_EQ( table.concat( v:getAny(), "," ), "3,1,2" )
+
+	-- maps are flattened into key/value pairs, sorted by key
+	v:setAnyAs( "QVariantMap", { "b", 2, "a", "x" } )
+	env.ASSERT_EQ( table.concat( v:getAny(), "," ), "a,x,b,2" )
+
+	local browser = qt.new( "QTextBrowser" )
+	browser.searchPaths = { "first", "second" }
+	env.ASSERT_EQ( table.concat( browser.searchPaths, "," ), "first,second" )
+end
+
+function testLuaValueConverters()
+	local conversions = 0
+	qt.registerValueConverter( "QDate",
+		function( value )
+			conversions = conversions + 1
+			local v = co.new( "qt.Variant" )
+			v:setAnyAs( "QString", value )
+			v:convert( "QDate" )
+			return v
+		end,
+		function( variant )
+			conversions = conversions + 1
+			variant:convert( "QString" )
+			return "date:" .. variant:getAny()
+		end )
+
+	local dateEdit = qt.new( "QDateEdit" )
+	dateEdit.date = "2012-03-04"
+	env.ASSERT_EQ( dateEdit.date, "date:2012-03-04" )
+	env.ASSERT_EQ( conversions, 2 )
+end
+
+function testNonLatin1Strings()
+	local window = qt.loadUi( file )
+	local button = window.btnOk
+
+	-- strings are bridged as UTF-8, so characters beyond Latin-1 survive the round trip
+	window.windowTitle = "Janela → 窓"
+	button.objectName = "botãoΩ"
+	env.ASSERT_EQ( window.windowTitle, "Janela → 窓" )
+	env.ASSERT_EQ( button.objectName, "botãoΩ" )
+	env.ASSERT_TRUE( window["botãoΩ"] == button )
+end
+
+function testChildLookupAfterRename()
+	local window = qt.loadUi( file )
+	local button = window.btnOk
+	env.ASSERT_EQ( window.btnRenamed, nil )
+
+	button.objectName = "btnRenamed"
+	env.ASSERT_EQ( window.btnOk, nil )
+	env.ASSERT_TRUE( window.btnRenamed == button )
+
+	button.objectName = "btnOk"
+	env.ASSERT_EQ( window.btnRenamed, nil )
+	env.ASSERT_TRUE( window.btnOk == button )
+end
+
+function testChildLookupAfterReparent()
+	local window = qt.loadUi( file )
+	local other = qt.loadUi( file )
+	local label = qt.new( "QLabel", other )
+	label.objectName = "movedLabel"
+	env.ASSERT_EQ( window.movedLabel, nil )
+	env.ASSERT_TRUE( other.movedLabel == label )
+
+	window.horizontalLayout:addWidget( label )
+	env.ASSERT_TRUE( window.movedLabel == label )
+	env.ASSERT_EQ( other.movedLabel, nil )
+end
+
+function testDynamicProperties()
+	local widget = qt.new( "QWidget" )
+	widget.customTag = "tagged"
+	widget.customSize = 3
+	env.ASSERT_EQ( widget.customTag, "tagged" )
+	env.ASSERT_EQ( widget.customSize, 3 )
+
+	-- objects without the property get a dynamic one, along with the others
+	local button = qt.new( "QPushButton" )
+	qt.applyProperty( { button, widget }, "text", "shared" )
+	env.ASSERT_EQ( button.text, "shared" )
+	env.ASSERT_EQ( widget.text, "shared" )
+end
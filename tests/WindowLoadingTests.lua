@@ -10,3 +10,33 @@ function aWindowShouldBeInvisibleWhenLoaded()
 	local widget = qt.loadUi( file )
 	env.ASSERT_TRUE( not widget.visible, "widget visible when opened" )
 end
+
+function relativePixmapPathsShouldBeResolvedAgainstTheUiFile()
+	-- the pixmap is next to the .ui file, not in the working directory
+	env.ASSERT_EQ( io.open( "icon.xpm" ), nil, "tests running from the resources directory" )
+
+	local window = qt.loadUi( "coral:../tests/resources/IconWindow.ui" )
+	env.ASSERT_TRUE( not window.iconLabel.pixmap:isNull(), "relative pixmap path not resolved" )
+
+	-- files kept in memory are resolved the same way
+	window = qt.loadUi( "coral:../tests/resources/IconWindow.ui" )
+	env.ASSERT_TRUE( not window.iconLabel.pixmap:isNull(), "relative pixmap path not resolved again" )
+end
+
+function modifiedWindowsShouldBeReadAgain()
+	local path = os.tmpname()
+	local function writeUi( title )
+		local f = io.open( path, "w" )
+		f:write( '<?xml version="1.0" encoding="UTF-8"?><ui version="4.0"><widget class="QWidget" name="Modified">' )
+		f:write( '<property name="windowTitle"><string>', title, '</string></property></widget></ui>' )
+		f:close()
+	end
+
+	writeUi( "First" )
+	env.ASSERT_EQ( qt.loadUi( path ).windowTitle, "First" )
+
+	-- the size changes, even if the modification time does not
+	writeUi( "Second title" )
+	env.ASSERT_EQ( qt.loadUi( path ).windowTitle, "Second title" )
+	os.remove( path )
+end